@@ -15,6 +15,8 @@
 //   [Press] the SW2 button to cycle through available brightness levels
 //   [Press and hold] the SW2 button (one second) to reset brightness to startup value
 //
+//   Hold SW2 while powering up for sound reactive patterns (needs AUDIO_REACTIVE)
+//
 //   Brightness, selected effect, and auto-cycle are saved in EEPROM after a delay
 //   The RGB Shades will automatically start up with the last-selected settings
 
@@ -22,6 +24,22 @@
 // RGB Shades data output to LEDs is on pin 5
 #define LED_PIN  6
 
+// Number of data pins the canvas is split across (see output.h)
+// Extra strips use LED_PIN_2..LED_PIN_4 in order. Without PARALLEL_OUTPUT or
+// DUAL_CORE_PIPELINE the strips are pushed one after the other, so on AVR more
+// strips only shorten the wires: show() takes as long as with one strip
+#define NUM_STRIPS 1
+#define LED_PIN_2 7
+#define LED_PIN_3 8
+#define LED_PIN_4 9
+
+// Uncomment to drive all strips from one FastLED parallel port driver
+// (for example WS2811_PORTD on Teensy 3.x); pins are fixed by the driver
+//#define PARALLEL_OUTPUT WS2811_PORTD
+
+// Uncomment on ESP32 to push frames from the second core while the next one renders
+//#define DUAL_CORE_PIPELINE
+
 // RGB Shades color order (Green/Red/Blue)
 #define COLOR_ORDER GRB
 #define CHIPSET     WS2812
@@ -36,19 +54,93 @@
 // Hue time (milliseconds between hue increments)
 #define hueTime 30
 
+// Run effects at 1/N of their designed frame rate to save CPU, 1 to 8
+// This only saves the effects' own drawing: a unit on its own still shows
+// the LEDs on every loop() pass, so show() takes as long as before. Effects
+// that advance by frameStep() or frameSteps() keep their speed; the stepped
+// ones (fire2D, life, colorFill, sideRain, scrollText, confetti) still run
+// every design frame's step and only draw less often. These step once per
+// frame by design and run N times slower: fireworks, xmasThreeDee, glitter
+// and flash, and the blur and fade trails, which last N times longer
+#define FRAME_DIVIDER 1
+
+// Render plasma, spinPlasma and threeSine every Nth frame and blend in between
+// (see keyframe.h), 1 disables it
+#define KEYFRAME_FRAMES 1
+
+// Uncomment to draw smooth field effects at half resolution and upscale (see lowres.h)
+//#define HALF_RES_FIELDS
+
 // Time after changing settings before settings are saved to EEPROM
 #define EEPROMDELAY 15000
 
+// Uncomment to keep 16 bits per channel so slow fades stay smooth (see deepcolor.h), needs more than 2K of RAM
+//#define DEEP_COLOR
+
+// Uncomment to enable the microphone input and sound reactive patterns (see audio.h)
+//#define AUDIO_REACTIVE
+
+// Uncomment to time every effect at startup and print the results over serial
+//#define BENCHMARK
+
+// Uncomment to print RAM use and stack headroom over serial (see memstats.h)
+//#define MEMORY_REPORT
+
+// Uncomment for effects with overlays drawn over them (see layers.h), NUM_LEDS / 2 bytes of RAM per layer
+//#define OVERLAY_LAYERS
+
+// Uncomment one to keep several units drawing the same frames over serial (see sync.h)
+//#define SYNC_LEADER
+//#define SYNC_FOLLOWER
+
+// Uncomment on ESP32 or ESP8266 to show E1.31 or Art-Net frames received over WiFi (see dmx.h)
+//#define DMX_RECEIVER
+
+// Uncomment to add an effect that runs a bytecode program uploaded over serial (see vm.h)
+//#define USER_PROGRAMS
+
+// Uncomment to change effect, brightness and other settings over serial (see control.h)
+//#define SERIAL_CONTROL
+
+// Uncomment to go dark and sleep when idle or at night (see power.h)
+//#define POWER_SAVE
+
 // Include FastLED library and other useful files
+#if defined(SYNC_LEADER) || defined(SYNC_FOLLOWER)
+#define USE_GET_MILLISECOND_TIMER // FastLED takes its time from the sync clock
+#endif
 #include <FastLED.h>
 #include <EEPROM.h>
 #include "messages.h"
 #include "font.h"
 #include "XYmap.h"
+#include "output.h"
+#include "deepcolor.h"
+#include "rng.h"
 #include "utils.h"
+#include "raster.h"
+#include "render3d.h"
+#include "keyframe.h"
+#include "lowres.h"
+#include "shader.h"
+#include "polarmap.h"
+#include "layers.h"
+#include "audio.h"
+#include "sync.h"
+#include "dmx.h"
 #include "FireworksXY.h"
+#include "RainXY.h"
+#include "NoiseXY.h"
+#include "LifeXY.h"
+#include "SpriteXY.h"
+#include "sprites.h"
 #include "effects.h"
+#include "vm.h"
+#include "control.h"
 #include "buttons.h"
+#include "power.h"
+#include "benchmark.h"
+#include "memstats.h"
 
 
 // list of functions that will be displayed
@@ -77,6 +169,24 @@ functionList effectListOne[] = {
   colorFill,
   glitter,
   spinPlasma,
+  lavaNoise,
+  cloudNoise,
+  oceanNoise,
+  fire2D,
+  lifeBounded,
+  lifeWrap,
+  hearts,
+  spinningShapes,
+  radialRipples,
+  spiralArms,
+  polarTunnel,
+  polarSwirl,
+  wireframeSolids,
+  starfield,
+  tunnelFlight,
+#ifdef USER_PROGRAMS
+  userProgram,
+#endif
 //  waves3,
 };
 
@@ -87,7 +197,19 @@ functionList effectListTwo[] = {
   scrollTextTwo,
   scrollTextThree,
   scrollTextFour,
+#ifdef OVERLAY_LAYERS
+  plasmaMessage,
+  snowFireworks,
+#endif
+};
+
+#ifdef AUDIO_REACTIVE
+// Sound reactive patterns
+functionList effectListThree[] = {
+  spectrumBars,
+  beatPulse,
 };
+#endif
 
 byte numEffects;
 
@@ -111,7 +233,17 @@ void setup() {
   }
 
   // write FastLED configuration data
-  FastLED.addLeds<CHIPSET, LED_PIN, COLOR_ORDER>(leds, LAST_VISIBLE_LED + 1);
+  setupOutput();
+  syncSetup();
+#ifdef DMX_RECEIVER
+  dmxSetup();
+#endif
+#ifdef USER_PROGRAMS
+  vmSetup();
+#endif
+#ifdef SERIAL_CONTROL
+  controlSetup();
+#endif
 
   // set global brightness value
   FastLED.setBrightness( scale8(currentBrightness, MAXBRIGHTNESS) );
@@ -135,9 +267,55 @@ void setup() {
     case 1: // Christmas patterns
       numEffects = (sizeof(effectListTwo) / sizeof(effectListTwo[0]));
       break;
+
+#ifdef AUDIO_REACTIVE
+    case 2: // sound reactive patterns
+      numEffects = (sizeof(effectListThree) / sizeof(effectListThree[0]));
+      audioSetup();
+      break;
+#endif
   }
 
   if (currentEffect > (numEffects - 1)) currentEffect = 0;
+
+#ifdef BENCHMARK
+  Serial.begin(BENCHMARK_BAUD);
+  benchmarkOutput();
+  benchmarkNoise();
+  benchmarkLife();
+  benchmarkRaster();
+  benchmarkShaders();
+  benchmarkRandom();
+  benchmark3D();
+#ifdef DEEP_COLOR
+  benchmarkDeep();
+#endif
+#ifdef USER_PROGRAMS
+  benchmarkVM();
+#endif
+  switch (runMode) {
+    case 0:
+      benchmarkEffects(effectListOne, numEffects);
+      break;
+
+    case 1:
+      benchmarkEffects(effectListTwo, numEffects);
+      break;
+
+#ifdef AUDIO_REACTIVE
+    case 2:
+      benchmarkAudio();
+      benchmarkEffects(effectListThree, numEffects);
+      break;
+#endif
+  }
+#endif
+
+#ifdef MEMORY_REPORT
+  Serial.begin(BENCHMARK_BAUD);
+  memoryReport();
+#endif
+
   effectInit = false;
 }
 
@@ -147,6 +325,11 @@ void loop()
 {
   currentMillis = millis(); // save the current timer value
 
+#ifdef POWER_SAVE
+  currentMillis += powerSlept;     // millis() stops while an AVR sleeps
+  if (powerSaving()) return;       // dark and asleep, nothing to draw
+#endif
+
   // wait for any buttons pressed before powerup to be released
   if (initialized == false) {
     if (getStartupButtons() == 0b11) initialized = true; // no buttons are pressed
@@ -156,6 +339,21 @@ void loop()
   }
 
   checkEEPROM();            // update the EEPROM if necessary
+#ifdef USER_PROGRAMS
+  vmSaveStep();             // write an uploaded program to EEPROM, a byte per pass
+#endif
+
+#if defined(SERIAL_CONTROL)
+  controlReceive();         // take in commands and uploads, a few bytes per pass
+#elif defined(USER_PROGRAMS)
+  vmReceive();              // take in uploaded effect programs
+#endif
+
+#ifdef DMX_RECEIVER
+  // frames from the network replace the effects while they keep arriving
+  if (dmxReceive()) showFrame();
+  if (dmxActive()) return;
+#endif
 
   // increment the global hue value every hueTime milliseconds
   if (currentMillis - hueMillis > hueTime) {
@@ -164,8 +362,11 @@ void loop()
   }
 
   // run the currently selected effect every effectDelay milliseconds
-  if (currentMillis - effectMillis > effectDelay) {
-    effectMillis = currentMillis;
+  boolean frameDrawn = false;
+  if (!audioFilling() && syncFrameDue()) {
+    unsigned long loopMillis = currentMillis;
+    currentMillis = syncMillis; // the leader's clock on a follower
+    updateFrameClock();
 
     switch (runMode) {
       case 0:
@@ -175,14 +376,28 @@ void loop()
       case 1:
         effectListTwo[currentEffect]();
         break;
+
+#ifdef AUDIO_REACTIVE
+      case 2:
+        audioAnalyze();
+        effectListThree[currentEffect]();
+        break;
+#endif
     }
 
+#ifdef OVERLAY_LAYERS
+    layersUpdate();     // redraw any overlay layers that are due
+    layersComposite();  // blend the overlays over the new frame
+#endif
+
     random16_add_entropy(1); // make the random values a bit more random-ish
+    currentMillis = loopMillis;
+    frameDrawn = true;
   }
 
   // switch to a new effect every cycleTime milliseconds
   if (repCount == 0) {
-    if (currentMillis - cycleMillis > cycleTime && autoCycle == true) {
+    if (currentMillis - cycleMillis > cycleTime && autoCycle == true && !syncFollowing()) {
       cyclePattern();
     }
   }
@@ -190,6 +405,14 @@ void loop()
   // run a fade effect
   if (fadingActive) fadeTo(fadeBaseColor, 1);
 
-  FastLED.show(); // send the contents of the led memory to the LEDs
+#ifdef DEEP_COLOR
+  deepResolve();      // dither the 16-bit frame down into leds[]
+#endif
+
+  syncShow(frameDrawn); // send the contents of the led memory to the LEDs
+
+#ifdef MEMORY_REPORT
+  memoryProbe();
+#endif
 }
 
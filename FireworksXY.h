@@ -2,17 +2,22 @@
 // Quick and dirty 2-D fireworks simulation using FastLED.
 // Adapted from code by Mark Kriegsman, July 2013
 
+// Sparks are drawn in the column order view (the old deg() mapping),
+// so the screen they see is kMatrixHeight wide and kMatrixWidth tall
+#define SCREEN_WIDTH  kMatrixHeight
+#define SCREEN_HEIGHT kMatrixWidth
+
 #define MODEL_BORDER 0
-#define MODEL_WIDTH  (MODEL_BORDER + kMatrixWidth + MODEL_BORDER)
-#define MODEL_HEIGHT (MODEL_BORDER + kMatrixWidth + MODEL_BORDER)
+#define MODEL_WIDTH  (MODEL_BORDER + SCREEN_WIDTH + MODEL_BORDER)
+#define MODEL_HEIGHT (MODEL_BORDER + SCREEN_HEIGHT + MODEL_BORDER)
 
-#define PIXEL_X_OFFSET ((MODEL_WIDTH  - kMatrixWidth ) / 2)
-#define PIXEL_Y_OFFSET ((MODEL_HEIGHT - kMatrixHeight) / 2)
+#define PIXEL_X_OFFSET ((MODEL_WIDTH  - SCREEN_WIDTH ) / 2)
+#define PIXEL_Y_OFFSET ((MODEL_HEIGHT - SCREEN_HEIGHT) / 2)
 
 #define WINDOW_X_MIN (PIXEL_X_OFFSET)
-#define WINDOW_X_MAX (WINDOW_X_MIN + kMatrixWidth - 1)
+#define WINDOW_X_MAX (WINDOW_X_MIN + SCREEN_WIDTH - 1)
 #define WINDOW_Y_MIN (PIXEL_Y_OFFSET)
-#define WINDOW_Y_MAX (WINDOW_Y_MIN + kMatrixHeight - 1)
+#define WINDOW_Y_MAX (WINDOW_Y_MIN + SCREEN_HEIGHT - 1)
 
 CRGB overrun;
 
@@ -78,7 +83,7 @@ class Dot {
       screenscale( x, MODEL_WIDTH - 1, ix, xe);
       screenscale( y, MODEL_HEIGHT - 1, iy, ye);
       ix -= PIXEL_X_OFFSET;
-      iy = kMatrixHeight - (iy - PIXEL_Y_OFFSET) - 1;
+      iy = SCREEN_HEIGHT - (iy - PIXEL_Y_OFFSET) - 1;
 
       yc = 255 - ye;
       xc = 255 - xe;
@@ -90,7 +95,7 @@ class Dot {
                        dim8_lin( scale8( scale8( color.b, yc), xc))
                      );
 
-      leds[deg(XY(ix, iy))] += c00;
+      leds[XY(iy, ix)] += c00;
       //leds[XY(ix, iy + 1)] += c01;
       //leds[XY(ix + 1, iy)] += c10;
       //leds[XY(ix + 1, iy + 1)] += c11;
@@ -161,7 +166,7 @@ class Dot {
 
     void GroundLaunch()
     {
-      yv = 600 + random16(300 + (25 * kMatrixHeight));
+      yv = 600 + random16(300 + (25 * SCREEN_HEIGHT));
       xv = (int16_t)random16(600) - (int16_t)300;
       y = 0;
       x = 0x8000;
@@ -0,0 +1,151 @@
+// LifeXY
+// Conway's Game of Life stored as one bitboard word per row (bit x == column x).
+// Neighbour counts for a whole row are built with bitwise adders: each row's
+// three-cell horizontal sum is a 2-bit number held in two words, and the sums
+// of the rows above and below plus the two side neighbours are added
+// column-parallel, so a generation costs a few dozen operations per row.
+
+static_assert(kMatrixWidth <= 64, "LifeXY keeps a row in one word, at most 64 columns");
+
+// Row word wide enough for the canvas (16 bits for one panel, 64 for large canvases)
+template<bool wide> struct LifeRowSelect {
+  typedef uint16_t type;
+};
+template<> struct LifeRowSelect<true> {
+  typedef uint64_t type;
+};
+typedef LifeRowSelect<(kMatrixWidth > 16)>::type lifeRow;
+
+#define LIFE_MASK ((lifeRow)(~(lifeRow)0) >> (sizeof(lifeRow) * 8 - kMatrixWidth))
+#define LIFE_HISTORY 4      // generations compared to detect still lifes and short cycles
+#define LIFE_MAX_AGE 1000   // reseed long runs that never settle
+
+lifeRow lifeRows[kMatrixHeight];
+uint16_t lifeHistory[LIFE_HISTORY];
+byte lifeHistoryIndex = 0;
+byte lifeHistoryCount = 0; // entries filled since the last seed
+uint16_t lifeAge = 0;
+
+// Neighbours to the left and right of every cell in a row
+lifeRow lifeLeft(lifeRow r, boolean wrap) {
+  lifeRow shifted = (r << 1) & LIFE_MASK;
+  if (wrap) shifted |= r >> (kMatrixWidth - 1);
+  return shifted;
+}
+
+lifeRow lifeRight(lifeRow r, boolean wrap) {
+  lifeRow shifted = r >> 1;
+  if (wrap) shifted |= (r & 1) << (kMatrixWidth - 1);
+  return shifted;
+}
+
+void lifeSeed() {
+  for (byte y = 0; y < kMatrixHeight; y++) {
+    lifeRow r = 0;
+    for (byte b = 0; b < sizeof(lifeRow); b += 2) {
+      r = (r << 16) | random16();
+    }
+    lifeRows[y] = r & LIFE_MASK;
+  }
+  lifeHistoryIndex = 0;
+  lifeHistoryCount = 0; // nothing to compare with yet
+  lifeAge = 0;
+}
+
+// Advance one generation, wrap joins opposite edges into a torus
+void lifeStep(boolean wrap) {
+  lifeRow first = lifeRows[0];
+  lifeRow above = wrap ? lifeRows[kMatrixHeight - 1] : 0;
+  lifeRow current = first;
+
+  // horizontal three-cell sums of the row above and the current row (bit 1, bit 0)
+  lifeRow l = lifeLeft(above, wrap), r = lifeRight(above, wrap);
+  lifeRow a0 = l ^ above ^ r;
+  lifeRow a1 = (l & above) | (r & (l ^ above));
+  l = lifeLeft(current, wrap);
+  r = lifeRight(current, wrap);
+  lifeRow c0 = l ^ current ^ r;
+  lifeRow c1 = (l & current) | (r & (l ^ current));
+
+  for (byte y = 0; y < kMatrixHeight; y++) {
+    lifeRow below;
+    if (y < kMatrixHeight - 1) {
+      below = lifeRows[y + 1];
+    } else {
+      below = wrap ? first : 0;
+    }
+
+    l = lifeLeft(below, wrap);
+    r = lifeRight(below, wrap);
+    lifeRow b0 = l ^ below ^ r;
+    lifeRow b1 = (l & below) | (r & (l ^ below));
+
+    // side neighbours of the current row only (0-2)
+    lifeRow sl = lifeLeft(current, wrap);
+    lifeRow sr = lifeRight(current, wrap);
+    lifeRow m0 = sl ^ sr;
+    lifeRow m1 = sl & sr;
+
+    // above + below, 0-6
+    lifeRow s0 = a0 ^ b0;
+    lifeRow carry = a0 & b0;
+    lifeRow s1 = a1 ^ b1 ^ carry;
+    lifeRow s2 = (a1 & b1) | (carry & (a1 ^ b1));
+
+    // + sides, anything from 4 up ends up in t2
+    lifeRow t0 = s0 ^ m0;
+    carry = s0 & m0;
+    lifeRow t1 = s1 ^ m1 ^ carry;
+    lifeRow t2 = s2 | (s1 & m1) | (carry & (s1 ^ m1));
+
+    // alive next generation with exactly 3 neighbours, or 2 and already alive
+    lifeRows[y] = ~t2 & t1 & (t0 | current) & LIFE_MASK;
+
+    above = current;
+    current = below;
+    a0 = c0;
+    a1 = c1;
+    c0 = b0;
+    c1 = b1;
+  }
+
+  lifeAge++;
+}
+
+// Fold the board into 16 bits for cycle detection
+uint16_t lifeHash() {
+  uint16_t hash = 0;
+  for (byte y = 0; y < kMatrixHeight; y++) {
+    lifeRow r = lifeRows[y];
+    hash = (hash << 3 | hash >> 13);
+    for (byte b = 0; b < sizeof(lifeRow); b += 2) {
+      hash ^= (uint16_t)r;
+      r >>= 8;
+      r >>= 8;
+    }
+  }
+  return hash;
+}
+
+// True when the board matches one of the last few generations
+boolean lifeStagnant() {
+  uint16_t hash = lifeHash();
+  boolean repeated = false;
+  for (byte i = 0; i < lifeHistoryCount; i++) {
+    if (lifeHistory[i] == hash) repeated = true;
+  }
+  lifeHistory[lifeHistoryIndex] = hash;
+  if (++lifeHistoryIndex >= LIFE_HISTORY) lifeHistoryIndex = 0;
+  if (lifeHistoryCount < LIFE_HISTORY) lifeHistoryCount++;
+  return repeated || lifeAge > LIFE_MAX_AGE;
+}
+
+// Draw live cells, dead cells are left to the global fade
+void lifeDraw(CRGB liveColor) {
+  for (byte y = 0; y < kMatrixHeight; y++) {
+    lifeRow r = lifeRows[y];
+    for (byte x = 0; r; x++, r >>= 1) {
+      if (r & 1) leds[XY(x, y)] = liveColor;
+    }
+  }
+}
@@ -0,0 +1,85 @@
+// NoiseXY
+// Amortized 3D noise field for smooth lava, cloud and ocean textures.
+// The field only moves along the time (z) axis, so its two octaves can be
+// refreshed at different rates instead of calling inoise8 twice per pixel:
+//   * the coarse octave is sampled on a grid every NOISE_CELL pixels each
+//     frame and bilinearly interpolated, it is smooth so nothing is lost
+//   * the fine octave is kept per pixel in effectScratch and one out of every
+//     NOISE_PHASES rows is refreshed per frame
+// A 16x16 frame costs 25 + 64 inoise8 calls instead of 512.
+
+#define NOISE_CELL 4
+#define NOISE_PHASES 4
+#define NOISE_GRID_W ((kMatrixWidth - 1) / NOISE_CELL + 2)
+#define NOISE_GRID_H ((kMatrixHeight - 1) / NOISE_CELL + 2)
+
+byte noiseCoarse[NOISE_GRID_W * NOISE_GRID_H];
+uint16_t noiseScale = 30; // coarse octave distance between pixels, 256 == one noise cell
+uint16_t noiseSpeed = 8;  // z movement per frame
+uint16_t noiseZ = 0;
+byte noisePhase = 0;
+
+// the fine octave lives in the shared effect scratch buffer
+#define noiseFine effectScratch
+
+void noiseUpdateCoarse() {
+  uint16_t i = 0;
+  for (byte gy = 0; gy < NOISE_GRID_H; gy++) {
+    for (byte gx = 0; gx < NOISE_GRID_W; gx++) {
+      noiseCoarse[i++] = inoise8(gx * NOISE_CELL * noiseScale, gy * NOISE_CELL * noiseScale, noiseZ);
+    }
+  }
+}
+
+// Refresh every NOISE_PHASES-th row of the fine octave, starting at firstRow
+void noiseUpdateFine(byte firstRow) {
+  uint16_t fineScale = noiseScale * 2;
+  for (byte y = firstRow; y < kMatrixHeight; y += NOISE_PHASES) {
+    byte *row = &noiseFine[y * kMatrixWidth];
+    for (byte x = 0; x < kMatrixWidth; x++) {
+      // offset the fine octave so it is not aligned with the coarse one
+      row[x] = inoise8(x * fineScale + 0x8000, y * fineScale, noiseZ * 2);
+    }
+  }
+}
+
+// Start a new field, fills both octaves completely
+void noiseInit(uint16_t scale, uint16_t speed) {
+  noiseScale = scale;
+  noiseSpeed = speed;
+  noiseZ = random16();
+  noisePhase = 0;
+  noiseUpdateCoarse();
+  for (byte p = 0; p < NOISE_PHASES; p++) noiseUpdateFine(p);
+}
+
+// Advance the field by one frame
+void noiseUpdate() {
+  noiseZ += frameStep(noiseSpeed);
+  noiseUpdateCoarse();
+  noiseUpdateFine(noisePhase);
+  if (++noisePhase >= NOISE_PHASES) noisePhase = 0;
+}
+
+// Map the field through the current palette into the LED array
+void noiseDraw() {
+  for (byte y = 0; y < kMatrixHeight; y++) {
+    byte gy = y / NOISE_CELL;
+    byte fy = (y % NOISE_CELL) * (256 / NOISE_CELL);
+    const byte *top = &noiseCoarse[gy * NOISE_GRID_W];
+    const byte *bottom = top + NOISE_GRID_W;
+    const byte *fine = &noiseFine[y * kMatrixWidth];
+
+    for (byte x = 0; x < kMatrixWidth; x++) {
+      byte gx = x / NOISE_CELL;
+      byte fx = (x % NOISE_CELL) * (256 / NOISE_CELL);
+      byte upper = lerp8by8(top[gx], top[gx + 1], fx);
+      byte lower = lerp8by8(bottom[gx], bottom[gx + 1], fx);
+      byte coarse = lerp8by8(upper, lower, fy);
+
+      // fine octave adds detail at a quarter of the coarse amplitude
+      byte value = qadd8(qsub8(coarse, 32), fine[x] >> 2);
+      leds[XY(x, y)] = ColorFromPalette(currentPalette, value, 255);
+    }
+  }
+}
@@ -0,0 +1,113 @@
+// RainXY
+// Falling code rain tracked as a list of drops per column.
+// Each drop keeps its own position, speed and trail length, and the trail
+// is drawn from the head position, so a frame only touches the pixels that
+// belong to active drops instead of scanning the whole array: each drop
+// erases the pixels it covered before it moves, then draws itself again.
+// The drops live in effectScratch, only matrixConsole uses them.
+
+// Rain uses the column order view (the old deg() mapping), so rain columns
+// run along the canvas height and drops fall along x
+#define RAIN_COLUMNS kMatrixHeight
+#define RAIN_ROWS    kMatrixWidth
+
+#define DROPS_PER_COLUMN 2
+
+#define RAIN_MIN_SPEED 48   // rows per frame in 1/256ths
+#define RAIN_MAX_SPEED 128
+#define RAIN_MIN_TRAIL 4
+#define RAIN_MAX_TRAIL 12
+
+const CRGB rainHeadColor = CRGB(175, 255, 175);
+const CRGB rainTrailColor = CRGB(27, 130, 39);
+
+byte rainDensity = 28; // chance of a new drop each frame, 0-255 (higher == more frequent spawns)
+byte rainActiveDrops = 0;
+
+// No constructor, so the drops can be kept in effectScratch (cleared by clearRain())
+class Drop {
+  public:
+    accum88 y;         // head position in rows, 8.8 fixed point
+    byte    show;
+    byte    speed;     // rows per design frame, 0.8 fixed point
+    byte    trail;     // trail length in pixels
+    byte    fadeStep;  // brightness lost per trail pixel
+
+    void Spawn()
+    {
+      y = 0;
+      speed = random8(RAIN_MIN_SPEED, RAIN_MAX_SPEED + 1);
+      trail = random8(RAIN_MIN_TRAIL, RAIN_MAX_TRAIL + 1);
+      fadeStep = 255 / (trail + 1);
+      show = 1;
+      rainActiveDrops++;
+    }
+
+    void Move()
+    {
+      if ( !show) return;
+      y += frameStep(speed);
+
+      // retire the drop once the end of its trail has left the bottom row
+      if ( (y >> 8) >= RAIN_ROWS + trail) {
+        show = 0;
+        rainActiveDrops--;
+      }
+    }
+
+    void Draw(byte col)
+    {
+      if ( !show) return;
+      int head = y >> 8;
+
+      // trail brightness falls off linearly with distance from the head
+      byte level = 255;
+      for ( byte k = 1; k <= trail; k++) {
+        level -= fadeStep;
+        int row = head - k;
+        if (row < 0) break;
+        if (row < RAIN_ROWS) leds[XY(row, col)] += rainTrailColor % level;
+      }
+
+      if (head < RAIN_ROWS) leds[XY(head, col)] = rainHeadColor;
+    }
+
+    // Black out the head and trail drawn last frame
+    void Erase(byte col)
+    {
+      if ( !show) return;
+      int head = y >> 8;
+      for (int row = head - trail; row <= head; row++) {
+        if (row >= 0 && row < RAIN_ROWS) leds[XY(row, col)] = CRGB::Black;
+      }
+    }
+
+    // true while the drop is still too close to the top for a new one to start behind it
+    bool Blocking()
+    {
+      return show && (y >> 8) <= trail;
+    }
+};
+
+#define gDrops ((Drop (*)[DROPS_PER_COLUMN])effectScratch)
+static_assert(sizeof(Drop) * RAIN_COLUMNS * DROPS_PER_COLUMN <= SCRATCH_SIZE, "rain drops do not fit in effectScratch");
+
+void clearRain() {
+  for (byte col = 0; col < RAIN_COLUMNS; col++) {
+    for (byte d = 0; d < DROPS_PER_COLUMN; d++) {
+      gDrops[col][d].show = 0;
+    }
+  }
+  rainActiveDrops = 0;
+}
+
+// Start a new drop in the given column if it has a free slot
+// and the previous drop has moved far enough down
+void spawnRain(byte col) {
+  Drop *freeDrop = NULL;
+  for (byte d = 0; d < DROPS_PER_COLUMN; d++) {
+    if (gDrops[col][d].Blocking()) return;
+    if (!gDrops[col][d].show) freeDrop = &gDrops[col][d];
+  }
+  if (freeDrop != NULL) freeDrop->Spawn();
+}
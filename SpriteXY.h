@@ -0,0 +1,65 @@
+// SpriteXY
+// Palette-indexed, run-length encoded sprites stored in flash.
+// Sprite data is generated from PNG sheets by tools/png2sprite.py:
+//   * palette: up to 16 colors as 0xRRGGBB, index 0 is transparent
+//   * frames:  offset of each animation frame in data
+//   * data:    one byte per run in row order, high nibble is the run
+//              length - 1, low nibble the palette index
+// Runs are decoded straight into leds[] while blitting, there is no
+// RAM copy of the image.
+
+#define SPRITE_NORMAL 0 // opaque pixels replace the background
+#define SPRITE_ADD 1    // opaque pixels are added to the background
+
+struct SpriteDef {
+  byte width;
+  byte height;
+  byte frameCount;
+  const uint32_t *palette;
+  const uint16_t *frames;
+  const byte *data;
+};
+
+// Draw one frame with its top left corner at (x0, y0), parts off the canvas are clipped
+void blitSprite(const SpriteDef *spriteP, byte frame, int16_t x0, int16_t y0, byte mode) {
+  SpriteDef sprite;
+  memcpy_P(&sprite, spriteP, sizeof(sprite));
+
+  const byte *run = sprite.data + pgm_read_word(&sprite.frames[frame]);
+  uint16_t remaining = sprite.width * sprite.height;
+  byte sx = 0;
+  int16_t y = y0;
+
+  while (remaining > 0 && y < kMatrixHeight) {
+    byte code = pgm_read_byte(run++);
+    byte length = (code >> 4) + 1;
+    byte index = code & 0x0F;
+    remaining -= length;
+
+    // transparent runs only move the cursor
+    if (index == 0) {
+      sx += length;
+      while (sx >= sprite.width) {
+        sx -= sprite.width;
+        y++;
+      }
+      continue;
+    }
+
+    CRGB color = pgm_read_dword(&sprite.palette[index]);
+    while (length--) {
+      int16_t x = x0 + sx;
+      if (x >= 0 && x < kMatrixWidth && y >= 0 && y < kMatrixHeight) {
+        if (mode == SPRITE_ADD) {
+          leds[XY(x, y)] += color;
+        } else {
+          leds[XY(x, y)] = color;
+        }
+      }
+      if (++sx >= sprite.width) {
+        sx = 0;
+        y++;
+      }
+    }
+  }
+}
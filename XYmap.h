@@ -25,20 +25,59 @@
 //             for use like this:  leds[ XY(x,y) ] == CRGB::Red;
 
 
-// Params for width and height
-const uint8_t kMatrixWidth = 16;
-const uint8_t kMatrixHeight = 16;
+// Params for a single panel (tile)
+const uint8_t kTileWidth = 16;
+const uint8_t kTileHeight = 16;
+
+// Number of panels across and down the canvas
+// Canvases larger than one 16x16 panel need more RAM than an AVR has
+// (the host tests set TILES_X, TILES_Y and TILE_MAP to try other layouts)
+#ifndef TILES_X
+#define TILES_X 1
+#define TILES_Y 1
+#endif
+const uint8_t kTilesX = TILES_X;
+const uint8_t kTilesY = TILES_Y;
+
+// Params for width and height of the whole canvas
+const uint8_t kMatrixWidth = kTileWidth * kTilesX;
+const uint8_t kMatrixHeight = kTileHeight * kTilesY;
+
+#define NUM_LEDS ((uint16_t)kMatrixWidth * kMatrixHeight)
+CRGB leds[ NUM_LEDS + 1 ]; // one hidden pixel catches out of bounds writes
+#define LAST_VISIBLE_LED (NUM_LEDS - 1)
+
+// Panel rotation (clockwise), 90 and 270 require square panels
+#define ROTATE_0   0
+#define ROTATE_90  1
+#define ROTATE_180 2
+#define ROTATE_270 3
+
+// How each panel is wired, listed left to right, top to bottom
+//   order:      position of the panel along the data line
+//   rotation:   how the panel is mounted
+//   serpentine: odd rows of the panel run right to left
+struct TileInfo {
+  uint8_t order;
+  uint8_t rotation;
+  boolean serpentine;
+};
+
+#ifndef TILE_MAP
+#define TILE_MAP {0, ROTATE_0, false},
+#endif
+const TileInfo tileMap[kTilesX * kTilesY] = {
+  TILE_MAP
+};
 
-#define NUM_LEDS (kMatrixWidth * kMatrixHeight)
-CRGB leds[ NUM_LEDS ];
-#define LAST_VISIBLE_LED 255
 uint16_t XY2 (uint8_t x, uint8_t y) {
   // any out of bounds address maps to the first hidden pixel
-  if ( (x >= kMatrixWidth) || (y >= kMatrixHeight) ) {
+  // table is for a single 16x16 panel
+  if ( (x >= 16) || (y >= 16) ) {
     return (LAST_VISIBLE_LED + 1);
   }
 
-  const uint8_t XYTable[] = {
+  static const uint8_t XYTable[] PROGMEM = {
     0,  16,  32,  48,  64,  80,  96, 112, 128, 144, 160, 176, 192, 208, 224, 240,
     1,  17,  33,  49,  65,  81,  97, 113, 129, 145, 161, 177, 193, 209, 225, 241,
     2,  18,  34,  50,  66,  82,  98, 114, 130, 146, 162, 178, 194, 210, 226, 242,
@@ -57,18 +96,62 @@ uint16_t XY2 (uint8_t x, uint8_t y) {
     15,  31,  47,  63,  79,  95, 111, 127, 143, 159, 175, 191, 207, 223, 239, 255
   };
 
-  uint8_t i = (y * kMatrixWidth) + x;
-  uint8_t j = XYTable[i];
+  uint8_t i = (y * 16) + x;
+  uint8_t j = pgm_read_byte(&XYTable[i]);
   return j;
 }
 
-// Trivial XY function for the SmartMatrix; use a different XY
-// function for different matrix grids.  See XYMatrix example for code.
-uint8_t XY( uint8_t x, uint8_t y) {
-  return (y * kMatrixWidth) + x;
+// True when the canvas is stored row by row, left to right, as one block,
+// so neighbouring pixels in a row are neighbours in leds[]
+inline boolean xyRowsContiguous() {
+  return kTilesX == 1 && kTilesY == 1 && tileMap[0].rotation == ROTATE_0 && !tileMap[0].serpentine;
 }
 
-int deg(int i) {
-  return ((i / 16) + ((i + 16) % 16 * 16));
-} // This function is dependent on 16x16 matrix
+// Map canvas coordinates to an LED index through the panel map
+// A single unrotated, non-serpentine panel reduces to (y * kMatrixWidth) + x
+uint16_t XY( uint8_t x, uint8_t y) {
+  // any out of bounds address maps to the first hidden pixel
+  if ( (x >= kMatrixWidth) || (y >= kMatrixHeight) ) {
+    return (LAST_VISIBLE_LED + 1);
+  }
 
+  if (xyRowsContiguous()) {
+    return (y * kMatrixWidth) + x;
+  }
+
+  const TileInfo &tile = tileMap[(y / kTileHeight) * kTilesX + (x / kTileWidth)];
+  uint8_t tx = x % kTileWidth;
+  uint8_t ty = y % kTileHeight;
+  uint8_t px, py;
+
+  switch (tile.rotation) {
+    case ROTATE_90:
+      px = ty;
+      py = kTileWidth - 1 - tx;
+      break;
+
+    case ROTATE_180:
+      px = kTileWidth - 1 - tx;
+      py = kTileHeight - 1 - ty;
+      break;
+
+    case ROTATE_270:
+      px = kTileHeight - 1 - ty;
+      py = tx;
+      break;
+
+    default:
+      px = tx;
+      py = ty;
+      break;
+  }
+
+  if (tile.serpentine && (py & 1)) px = kTileWidth - 1 - px;
+
+  return (uint16_t)tile.order * (kTileWidth * kTileHeight) + (py * kTileWidth) + px;
+}
+
+// Treat i as a column order index (x * kMatrixHeight + y)
+uint16_t deg(uint16_t i) {
+  return XY(i / kMatrixHeight, i % kMatrixHeight);
+}
@@ -0,0 +1,235 @@
+// Audio input for sound reactive effects
+// A microphone on MIC_PIN is sampled at a fixed rate into a ring buffer.
+// Each effect frame, audioAnalyze() runs an integer FFT over the newest
+// FFT_N samples and publishes the results in globals for effects to use:
+//   audioBands[]  smoothed energy per frequency band, 0-255
+//   audioLevel    overall loudness, 0-255
+//   audioBeat     true for the frame in which a bass beat was detected
+//
+// Samples are taken by an interrupt at a fixed rate, which the FFT bins rely on:
+//   AVR     the ADC runs free at 16 MHz / 128 / 13 = 9615 Hz, its interrupt
+//           stores each result
+//   ESP32   a hardware timer every AUDIO_SAMPLE_MICROS wakes a sampler task
+//           (analogRead() isn't safe in the interrupt itself)
+//   Teensy  an IntervalTimer every AUDIO_SAMPLE_MICROS reads the ADC
+//   host    the host build calls audioStore() at the sample rate itself
+// A sample the ESP32 task is too late for is skipped, not taken late.
+//
+// show() can hold interrupts off for longer than a window takes to fill (256
+// LEDs about 7.7 ms on AVR, FFT_N 64 about 6.7 ms), and the samples either
+// side of it are no longer a fixed time apart. So in sound mode only new
+// frames are shown, each show starts a fresh window, and the next frame waits
+// until FFT_N samples have been taken since.
+
+#ifdef AUDIO_REACTIVE
+
+#define MIC_PIN 0          // analog input number (A0)
+#ifndef FFT_N
+#define FFT_N 64           // 64 or 128 samples, 128 halves the bin width
+#endif
+#define NUM_BANDS 8
+#define AUDIO_SAMPLE_MICROS 104
+#define BEAT_HOLDOFF 200   // minimum milliseconds between beats
+
+static_assert(FFT_N == 64 || FFT_N == 128, "FFT_N must be 64 or 128");
+
+// First FFT bin of each band for FFT_N 64, roughly logarithmic; the last entry
+// ends the top band. Doubled for FFT_N 128, so the bands keep their frequencies.
+const byte bandEdges[NUM_BANDS + 1] PROGMEM = {1, 2, 3, 5, 8, 12, 17, 24, 32};
+#define BAND_BIN_SCALE (FFT_N / 64)
+
+volatile byte audioRing[FFT_N];
+volatile byte audioHead = 0;
+volatile byte audioFresh = 0; // samples since the last show, stops at FFT_N
+
+int16_t fftReal[FFT_N];
+int16_t fftImag[FFT_N];
+
+byte audioBands[NUM_BANDS];
+byte audioLevel = 0;
+boolean audioBeat = false;
+
+uint16_t bassAverage = 0;
+unsigned long beatMillis = 0;
+
+// Add one sample, 128 is silence
+inline void audioStore(byte sample) {
+  audioRing[audioHead++ & (FFT_N - 1)] = sample;
+  if (audioFresh < FFT_N) audioFresh++;
+}
+
+// True in sound mode, where frames are only shown when drawn
+boolean audioSampling() {
+  return runMode == 2;
+}
+
+// True while the window since the last show isn't full yet
+boolean audioFilling() {
+  return audioSampling() && audioFresh < FFT_N;
+}
+
+// Called after each show(), the samples before it don't join up with the next
+void audioShown() {
+  audioFresh = 0;
+}
+
+#if defined(__AVR__)
+ISR(ADC_vect) {
+  audioStore(ADCH);
+}
+
+void audioSetup() {
+  ADMUX = _BV(REFS0) | _BV(ADLAR) | (MIC_PIN & 0x07); // AVcc reference, 8-bit result in ADCH
+  ADCSRB = 0;                                        // free running
+  DIDR0 = _BV(MIC_PIN & 0x07);                       // disable the digital input buffer
+  ADCSRA = _BV(ADEN) | _BV(ADSC) | _BV(ADATE) | _BV(ADIE) | _BV(ADPS2) | _BV(ADPS1) | _BV(ADPS0);
+}
+
+#elif defined(ESP32)
+#define AUDIO_TASK_STACK 2048
+#define AUDIO_TASK_PRIORITY (configMAX_PRIORITIES - 1)
+
+hw_timer_t *audioTimer = NULL;
+TaskHandle_t audioTask = NULL;
+
+void IRAM_ATTR audioTimerISR() {
+  BaseType_t woken = pdFALSE;
+  vTaskNotifyGiveFromISR(audioTask, &woken);
+  if (woken) portYIELD_FROM_ISR();
+}
+
+void audioSampler(void * /*params*/) {
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY); // ticks that came while busy are dropped
+    audioStore(analogRead(MIC_PIN) >> 4);    // 12-bit ADC
+  }
+}
+
+void audioSetup() {
+  xTaskCreatePinnedToCore(audioSampler, "audio", AUDIO_TASK_STACK, NULL,
+                          AUDIO_TASK_PRIORITY, &audioTask, xPortGetCoreID());
+#if ESP_ARDUINO_VERSION_MAJOR >= 3
+  audioTimer = timerBegin(1000000);
+  timerAttachInterrupt(audioTimer, audioTimerISR);
+  timerAlarm(audioTimer, AUDIO_SAMPLE_MICROS, true, 0);
+#else
+  audioTimer = timerBegin(0, 80, true); // 80 MHz APB clock / 80, 1 us per count
+  timerAttachInterrupt(audioTimer, audioTimerISR, true);
+  timerAlarmWrite(audioTimer, AUDIO_SAMPLE_MICROS, true);
+  timerAlarmEnable(audioTimer);
+#endif
+}
+
+#elif defined(CORE_TEENSY)
+IntervalTimer audioTimer;
+
+void audioTimerISR() {
+  audioStore(analogRead(MIC_PIN) >> 2);
+}
+
+void audioSetup() {
+  audioTimer.begin(audioTimerISR, AUDIO_SAMPLE_MICROS);
+}
+
+#elif defined(__linux__) || defined(__APPLE__)
+void audioSetup() {} // the host build feeds audioStore()
+
+#else
+#error "AUDIO_REACTIVE needs a sampling timer for this board (AVR, ESP32 or Teensy)"
+#endif
+
+// In-place radix-2 FFT of fftReal/fftImag, each stage halves the values
+// so the result is scaled by 1/FFT_N and cannot overflow
+void fftTransform(int16_t *re, int16_t *im) {
+
+  // bit reversal permutation
+  for (byte i = 1, j = 0; i < FFT_N; i++) {
+    uint16_t bit = FFT_N >> 1;
+    for (; j & bit; bit >>= 1) j ^= bit;
+    j ^= bit;
+    if (i < j) {
+      int16_t t = re[i]; re[i] = re[j]; re[j] = t;
+      t = im[i]; im[i] = im[j]; im[j] = t;
+    }
+  }
+
+  for (uint16_t len = 2; len <= FFT_N; len <<= 1) {
+    uint16_t half = len >> 1;
+    uint16_t step = 65536UL / len;
+
+    for (byte k = 0; k < half; k++) {
+      // twiddle factor e^(-2 pi i k / len) in 1.15 fixed point
+      int16_t wr = cos16(k * step);
+      int16_t wi = -sin16(k * step);
+
+      for (byte i = k; i < FFT_N; i += len) {
+        byte j = i + half;
+        int16_t tr = ((int32_t)wr * re[j] - (int32_t)wi * im[j]) >> 15;
+        int16_t ti = ((int32_t)wr * im[j] + (int32_t)wi * re[j]) >> 15;
+        re[j] = (re[i] - tr) >> 1;
+        im[j] = (im[i] - ti) >> 1;
+        re[i] = (re[i] + tr) >> 1;
+        im[i] = (im[i] + ti) >> 1;
+      }
+    }
+  }
+}
+
+// Approximate magnitude without a square root (alpha max plus beta min)
+uint16_t fftMagnitude(int16_t re, int16_t im) {
+  uint16_t a = abs(re);
+  uint16_t b = abs(im);
+  return (a > b) ? a + (b >> 1) : b + (a >> 1);
+}
+
+// Transform the newest samples and update the published band energies and beat
+void audioAnalyze() {
+  // copy out the ring buffer oldest first, centre it and apply a Hann window
+  byte head = audioHead;
+  for (byte i = 0; i < FFT_N; i++) {
+    int16_t sample = (int16_t)audioRing[(head + i) & (FFT_N - 1)] - 128;
+    byte window = 128 - (cos8(i * (256 / FFT_N)) >> 1);
+    fftReal[i] = (sample * window) >> 3;
+    fftImag[i] = 0;
+  }
+
+  fftTransform(fftReal, fftImag);
+
+  uint16_t total = 0;
+  for (byte b = 0; b < NUM_BANDS; b++) {
+    byte first = pgm_read_byte(&bandEdges[b]) * BAND_BIN_SCALE;
+    byte last = pgm_read_byte(&bandEdges[b + 1]) * BAND_BIN_SCALE;
+    uint16_t peak = 0;
+    for (byte bin = first; bin < last; bin++) {
+      uint16_t mag = fftMagnitude(fftReal[bin], fftImag[bin]);
+      if (mag > peak) peak = mag;
+    }
+
+    // rise immediately, fall back slowly
+    byte energy = (peak > 255) ? 255 : peak;
+    if (energy > audioBands[b]) {
+      audioBands[b] = energy;
+    } else {
+      audioBands[b] = qsub8(audioBands[b], 8);
+    }
+    total += audioBands[b];
+  }
+  audioLevel = total / NUM_BANDS;
+
+  // a beat is bass well above its running average
+  uint16_t bass = audioBands[0] + audioBands[1];
+  audioBeat = false;
+  if (bass > bassAverage + (bassAverage >> 1) + 16 && currentMillis - beatMillis > BEAT_HOLDOFF) {
+    audioBeat = true;
+    beatMillis = currentMillis;
+  }
+  bassAverage = bassAverage - (bassAverage >> 3) + (bass >> 3);
+}
+
+#else
+
+boolean audioSampling() { return false; }
+boolean audioFilling() { return false; }
+void audioShown() {}
+
+#endif
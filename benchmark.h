@@ -0,0 +1,343 @@
+// Effect timing over the serial port
+// Define BENCHMARK in FindMyWay.ino to time each effect at startup and print
+// the average render cost per frame and per pixel for the configured canvas.
+// Change kTilesX/kTilesY in XYmap.h and rerun to see how cost scales with size.
+
+#define BENCHMARK_FRAMES 100
+#define BENCHMARK_BAUD 115200
+
+// Run a function BENCHMARK_FRAMES times and return the average time in microseconds
+unsigned long benchmarkFunction(functionList func) {
+  effectInit = false;
+  unsigned long start = micros();
+  for (int f = 0; f < BENCHMARK_FRAMES; f++) {
+    func();
+  }
+  return (micros() - start) / BENCHMARK_FRAMES;
+}
+
+// Print one result line: label, us per frame, ns per pixel, fps including output
+void benchmarkReport(const char *label, byte index, unsigned long frameMicros) {
+  Serial.print(label);
+  Serial.print(index);
+  Serial.print(F("\t"));
+  Serial.print(frameMicros);
+  Serial.print(F(" us/frame\t"));
+  Serial.print(frameMicros * 1000 / NUM_LEDS);
+  Serial.print(F(" ns/pixel\t"));
+  Serial.print(outputMaxFPS(frameMicros));
+  Serial.println(F(" fps"));
+}
+
+void benchmarkCanvas() {
+  Serial.print(F("canvas "));
+  Serial.print(kMatrixWidth);
+  Serial.print(F("x"));
+  Serial.print(kMatrixHeight);
+  Serial.print(F(" = "));
+  Serial.print(NUM_LEDS);
+  Serial.println(F(" pixels"));
+}
+
+// Compare the output timing model against a measured show()
+void benchmarkOutput() {
+  Serial.print(NUM_STRIPS);
+  Serial.print(F(" strips x "));
+  Serial.print(STRIP_LEDS);
+  Serial.print(OUTPUT_CONCURRENT ? F(" pixels, concurrent") : F(" pixels, sequential"));
+  Serial.print(F("\tmodel "));
+  Serial.print(outputPushMicros());
+  Serial.print(F(" us/push, "));
+  Serial.print(outputMaxFPS(0));
+  Serial.print(F(" fps max\tmeasured "));
+
+  unsigned long start = micros();
+  for (int f = 0; f < BENCHMARK_FRAMES; f++) {
+    FastLED.show();
+  }
+  Serial.print((micros() - start) / BENCHMARK_FRAMES);
+  Serial.println(F(" us/push"));
+}
+
+#ifdef AUDIO_REACTIVE
+// Time one audio analysis pass (copy, window, FFT, bands, beat)
+void benchmarkAudio() {
+  unsigned long start = micros();
+  for (int f = 0; f < BENCHMARK_FRAMES; f++) {
+    audioAnalyze();
+  }
+  Serial.print(F("audio FFT_N="));
+  Serial.print(FFT_N);
+  Serial.print(F("\t"));
+  Serial.print((micros() - start) / BENCHMARK_FRAMES);
+  Serial.println(F(" us/analysis"));
+}
+#endif
+
+// Reference for NoiseXY: both octaves sampled per pixel, every frame
+void naiveNoise() {
+  static uint16_t z = 0;
+  z += noiseSpeed;
+  for (byte y = 0; y < kMatrixHeight; y++) {
+    for (byte x = 0; x < kMatrixWidth; x++) {
+      byte coarse = inoise8(x * noiseScale, y * noiseScale, z);
+      byte fine = inoise8(x * noiseScale * 2 + 0x8000, y * noiseScale * 2, z * 2);
+      leds[XY(x, y)] = ColorFromPalette(currentPalette, qadd8(qsub8(coarse, 32), fine >> 2), 255);
+    }
+  }
+}
+
+void noiseEngine() {
+  noiseUpdate();
+  noiseDraw();
+}
+
+void benchmarkNoise() {
+  noiseInit(30, 6);
+  benchmarkReport("noise naive ", 0, benchmarkFunction(naiveNoise));
+  benchmarkReport("noise engine ", 0, benchmarkFunction(noiseEngine));
+}
+
+// Reference for LifeXY: count the eight neighbours of every cell one at a time
+void naiveLife() {
+  static lifeRow next[kMatrixHeight];
+  for (byte y = 0; y < kMatrixHeight; y++) {
+    next[y] = 0;
+    for (byte x = 0; x < kMatrixWidth; x++) {
+      byte count = 0;
+      for (int8_t dy = -1; dy <= 1; dy++) {
+        for (int8_t dx = -1; dx <= 1; dx++) {
+          int8_t nx = x + dx;
+          int8_t ny = y + dy;
+          if ((dx || dy) && nx >= 0 && nx < kMatrixWidth && ny >= 0 && ny < kMatrixHeight) {
+            count += (lifeRows[ny] >> nx) & 1;
+          }
+        }
+      }
+      if (count == 3 || (count == 2 && ((lifeRows[y] >> x) & 1))) next[y] |= (lifeRow)1 << x;
+    }
+  }
+  memcpy(lifeRows, next, sizeof(lifeRows));
+}
+
+void bitboardLife() {
+  lifeStep(false);
+}
+
+void benchmarkLife() {
+  lifeSeed();
+  benchmarkReport("life naive ", 0, benchmarkFunction(naiveLife));
+  lifeSeed();
+  benchmarkReport("life bitboard ", 0, benchmarkFunction(bitboardLife));
+}
+
+// Cost of each raster.h primitive
+void benchLine() {
+  drawLine(0, 0, FIX88(kMatrixWidth - 1), FIX88(kMatrixHeight / 2), CRGB::White);
+}
+
+void benchLineAA() {
+  drawLineAA(0, 0, FIX88(kMatrixWidth - 1), FIX88(kMatrixHeight / 2), CRGB::White);
+}
+
+void benchRect() {
+  fillRect(1, 1, kMatrixWidth - 2, kMatrixHeight - 2, CRGB::White);
+}
+
+void benchCircle() {
+  fillCircle(FIX88(kMatrixWidth / 2), FIX88(kMatrixHeight / 2), FIX88(kMatrixHeight / 2 - 1), CRGB::White);
+}
+
+void benchPolygon() {
+  const fix88 xs[5] = {FIX88(1), FIX88(kMatrixWidth - 2), FIX88(kMatrixWidth - 4), FIX88(kMatrixWidth / 2), FIX88(3)};
+  const fix88 ys[5] = {FIX88(2), FIX88(1), FIX88(kMatrixHeight - 2), FIX88(kMatrixHeight / 2), FIX88(kMatrixHeight - 3)};
+  fillPolygon(xs, ys, 5, CRGB::White);
+}
+
+void benchmarkRaster() {
+  benchmarkReport("line ", 0, benchmarkFunction(benchLine));
+  benchmarkReport("line AA ", 0, benchmarkFunction(benchLineAA));
+  benchmarkReport("fill rect ", 0, benchmarkFunction(benchRect));
+  benchmarkReport("fill circle ", 0, benchmarkFunction(benchCircle));
+  benchmarkReport("fill polygon ", 0, benchmarkFunction(benchPolygon));
+}
+
+// References for shader.h: the shaded effects as plain x/y loops through XY()
+byte loopPhase = 0;
+
+void loopThreeSine() {
+  loopPhase++;
+  for (byte x = 0; x < FIELD_WIDTH; x += FIELD_STEP) {
+    for (int y = 0; y < FIELD_HEIGHT; y += FIELD_STEP) {
+      byte sinDistanceR = qmul8(abs(y * (255 / kMatrixHeight) - sin8(loopPhase * 9 + x * 16)), 2);
+      byte sinDistanceG = qmul8(abs(y * (255 / kMatrixHeight) - sin8(loopPhase * 10 + x * 16)), 2);
+      byte sinDistanceB = qmul8(abs(y * (255 / kMatrixHeight) - sin8(loopPhase * 11 + x * 16)), 2);
+      fieldPixel(x, y) = CRGB(255 - sinDistanceR, 255 - sinDistanceG, 255 - sinDistanceB);
+    }
+  }
+  fieldUpscale();
+}
+
+void loopSlantBars() {
+  loopPhase -= 4;
+  for (byte x = 0; x < kMatrixWidth; x++) {
+    for (byte y = 0; y < kMatrixHeight; y++) {
+      leds[XY(x, y)] = CHSV(cycleHue, 255, quadwave8(x * 16 + y * 16 + loopPhase));
+    }
+  }
+}
+
+void loopCandycane() {
+  loopPhase -= 4;
+  for (byte x = 0; x < kMatrixWidth; x++) {
+    for (byte y = 0; y < kMatrixHeight; y++) {
+      leds[XY(x, y)] = blend(CRGB::Red, CRGB::White, cubicwave8(x * 32 + y * 32 + loopPhase));
+    }
+  }
+}
+
+void loopCheckerboard() {
+  loopPhase += 2;
+  CRGB colorOne = ColorFromPalette(currentPalette, loopPhase);
+  CRGB colorTwo = ColorFromPalette(currentPalette, loopPhase + 64);
+  for (byte x = 0; x < kMatrixWidth; x++) {
+    for (byte y = 0; y < kMatrixHeight; y++) {
+      leds[XY(x, y)] = (((x % 2) + y) % 2) ? colorOne : colorTwo;
+    }
+  }
+}
+
+void benchmarkShaders() {
+  benchmarkReport("threeSine loop ", 0, benchmarkFunction(loopThreeSine));
+  benchmarkReport("threeSine shader ", 0, benchmarkFunction(threeSine));
+  benchmarkReport("slantBars loop ", 0, benchmarkFunction(loopSlantBars));
+  benchmarkReport("slantBars shader ", 0, benchmarkFunction(slantBars));
+  benchmarkReport("candycane loop ", 0, benchmarkFunction(loopCandycane));
+  benchmarkReport("candycane shader ", 0, benchmarkFunction(candycaneSlantbars));
+  benchmarkReport("checkerboard loop ", 0, benchmarkFunction(loopCheckerboard));
+  benchmarkReport("checkerboard shader ", 0, benchmarkFunction(checkerboard));
+}
+
+#ifdef USER_PROGRAMS
+// The built-in bytecode slantBars against the compiled one
+void benchmarkVM() {
+  memcpy_P(vmProgram, vmDefaultProgram, sizeof(vmDefaultProgram));
+  benchmarkReport("slantBars compiled ", 0, benchmarkFunction(slantBars));
+  benchmarkReport("slantBars bytecode ", 0, benchmarkFunction(vmFrame));
+}
+#endif
+
+// References for rng.h: the FastLED generator, and glitter, confetti and snow
+// drawing from random8()/random16() and Arduino's random() as they did
+void benchRandom8() {
+  for (uint16_t i = 0; i < NUM_LEDS; i++) effectScratch[i] = random8();
+}
+
+void benchRngFill() {
+  rngFill(effectScratch, NUM_LEDS);
+}
+
+void loopGlitter() {
+  for (int x = 0; x < kMatrixWidth; x++) {
+    for (int y = 0; y < kMatrixHeight; y++) {
+      leds[XY(x, y)] = CHSV(cycleHue, 255, random8(5) * 63);
+    }
+  }
+}
+
+void loopConfetti() {
+  for (byte i = 0; i < 4; i++) {
+    leds[XY(random16(kMatrixWidth), random8(kMatrixHeight))] = ColorFromPalette(currentPalette, random16(255), 255);
+    random16_add_entropy(1);
+  }
+}
+
+void loopSnow() {
+  static unsigned int snowCols[kMatrixHeight] = {0};
+  CRGB snowColor = CRGB::White;
+  fillAll(CRGB::Black);
+  for (int i = 0; i < kMatrixHeight; i++) {
+    if (snowCols[i] > 0) {
+      snowCols[i] += frameStep(random(4, 16));
+    } else {
+      if (random16(100 * 256) < frameTicks) snowCols[i] = 1;
+    }
+    byte tempY = snowCols[i] >> 8;
+    byte tempRem = snowCols[i] & 0xFF;
+    if (tempY > 0 && tempY <= kMatrixWidth) leds[XY(tempY - 1, i)] = snowColor % dim8_raw(255 - tempRem);
+    if (tempY < kMatrixWidth) leds[XY(tempY, i)] = snowColor % dim8_raw(tempRem);
+    if (tempY > kMatrixWidth) snowCols[i] = 0;
+  }
+}
+
+void benchmarkRandom() {
+  benchmarkReport("random8 ", 0, benchmarkFunction(benchRandom8));
+  benchmarkReport("rngFill ", 0, benchmarkFunction(benchRngFill));
+  benchmarkReport("glitter random8 ", 0, benchmarkFunction(loopGlitter));
+  benchmarkReport("glitter rng ", 0, benchmarkFunction(glitter));
+  benchmarkReport("confetti random8 ", 0, benchmarkFunction(loopConfetti));
+  benchmarkReport("confetti rng ", 0, benchmarkFunction(confetti));
+  benchmarkReport("snow random ", 0, benchmarkFunction(loopSnow));
+  benchmarkReport("snow rng ", 0, benchmarkFunction(snow));
+}
+
+// render3d.h: the transform and projection of 100 points, then the 3D effects
+#define BENCHMARK_POINTS_3D 100
+
+void benchProject3D() {
+  Matrix3D turn;
+  rotation3D(turn, loopPhase, loopPhase * 2, 0);
+  loopPhase++;
+
+  fix88 sx, sy;
+  for (byte i = 0; i < BENCHMARK_POINTS_3D; i++) {
+    Point3D p = {(fix88)(i * 10 - 500), (fix88)(i * 37 % 512 - 256), (fix88)(i * 3)};
+    p = transform3D(turn, p);
+    p.z += FIX88(3);
+    render3DProject(p, sx, sy);
+  }
+}
+
+void benchmark3D() {
+  benchmarkReport("project 100 points ", 0, benchmarkFunction(benchProject3D));
+  benchmarkReport("wireframe solids ", 0, benchmarkFunction(wireframeSolids));
+  benchmarkReport("starfield ", 0, benchmarkFunction(starfield));
+  benchmarkReport("tunnel flight ", 0, benchmarkFunction(tunnelFlight));
+}
+
+#ifdef DEEP_COLOR
+// What the 16-bit buffer adds per frame, against the 8-bit fade it replaces
+void benchFade8() {
+  for (uint16_t i = 0; i < NUM_LEDS; i++) leds[i].fadeToBlackBy(1);
+}
+
+void benchFadeDeep() {
+  fadeAll(1);
+}
+
+void benchmarkDeep() {
+  Serial.print(F("deep color "));
+  Serial.print(sizeof(deepLeds) + sizeof(deepError));
+  Serial.println(F(" bytes"));
+  benchmarkReport("fadeAll 8-bit ", 0, benchmarkFunction(benchFade8));
+  benchmarkReport("fadeAll deep ", 0, benchmarkFunction(benchFadeDeep));
+  benchmarkReport("deep resolve ", 0, benchmarkFunction(deepResolve));
+}
+#endif
+
+// Time every effect in a list, then restore the effect state
+void benchmarkEffects(functionList list[], byte count) {
+  byte savedEffect = currentEffect;
+
+  benchmarkCanvas();
+  for (byte i = 0; i < count; i++) {
+    currentEffect = i;
+    benchmarkReport("effect ", i, benchmarkFunction(list[i]));
+  }
+
+  currentEffect = savedEffect;
+  effectInit = false;
+  fadingActive = false;
+  repCount = 0;
+  fillAll(CRGB::Black);
+}
@@ -0,0 +1,131 @@
+// Settings over serial
+// With SERIAL_CONTROL defined the effect, brightness, auto-cycle, palette and
+// the running effect's frame time can be changed from a host without touching
+// the buttons. Commands are 4 byte packets:
+//   0  CONTROL_START
+//   1  command, one of the CONTROL_ values below
+//   2  value
+//   3  sum of bytes 1 and 2
+// Every packet that checks out is answered with a status packet:
+//   CONTROL_START, currentEffect, currentBrightness, autoCycle, runMode, sum of bytes 1-4
+//
+// Bytes are taken from the serial port's receive buffer, which the UART
+// interrupt fills as a ring, at most CONTROL_BUDGET of them per loop() pass,
+// so a burst of commands is spread over a few passes instead of holding up a
+// frame. Replies are dropped rather than waited for when the transmit buffer
+// is full. Effect, brightness and auto-cycle are saved to EEPROM like button
+// presses are; palette and frame time last until the effect starts over.
+//
+// With USER_PROGRAMS defined program uploads come in on the same port and are
+// passed on to vm.h. CONTROL_PORT can't be shared with SYNC_LEADER/FOLLOWER,
+// BENCHMARK or MEMORY_REPORT. tools/control.py sends the commands.
+
+#ifdef SERIAL_CONTROL
+
+#define CONTROL_PORT Serial
+#define CONTROL_BAUD 115200
+#define CONTROL_BUDGET 8 // bytes parsed per loop() pass
+#define CONTROL_START 0xC3
+#define CONTROL_PACKET_SIZE 4
+#define CONTROL_STATUS_SIZE 6
+
+#define CONTROL_GET_STATUS 0 // value unused
+#define CONTROL_EFFECT 1     // effect number in the current list
+#define CONTROL_NEXT 2       // value unused
+#define CONTROL_BRIGHTNESS 3 // 0-255, scaled to MAXBRIGHTNESS
+#define CONTROL_AUTOCYCLE 4  // 0 or 1
+#define CONTROL_PALETTE 5    // 0-7 as selectPalette()
+#define CONTROL_DELAY 6      // effectDelay in ms for the running effect
+
+byte controlPacket[CONTROL_PACKET_SIZE - 1];
+byte controlReceived = 0; // bytes of the current packet after the start
+
+void controlSetup() {
+  CONTROL_PORT.begin(CONTROL_BAUD);
+}
+
+// Save the settings after EEPROMDELAY, as a button press would
+void controlChanged() {
+  eepromMillis = currentMillis;
+  eepromOutdated = true;
+}
+
+void controlStatus() {
+  byte packet[CONTROL_STATUS_SIZE] = {CONTROL_START, currentEffect, currentBrightness, autoCycle, runMode, 0};
+  for (byte i = 1; i < CONTROL_STATUS_SIZE - 1; i++) packet[CONTROL_STATUS_SIZE - 1] += packet[i];
+  if (CONTROL_PORT.availableForWrite() >= CONTROL_STATUS_SIZE) CONTROL_PORT.write(packet, CONTROL_STATUS_SIZE);
+}
+
+void controlCommand(byte command, byte value) {
+  switch (command) {
+    case CONTROL_EFFECT:
+      if (value >= numEffects) break;
+      currentEffect = value;
+      cycleMillis = currentMillis;
+      effectInit = false;
+      fadingActive = false;
+      controlChanged();
+      break;
+
+    case CONTROL_NEXT:
+      cyclePattern();
+      controlChanged();
+      break;
+
+    case CONTROL_BRIGHTNESS:
+      currentBrightness = value;
+      FastLED.setBrightness(scale8(currentBrightness, MAXBRIGHTNESS));
+      controlChanged();
+      break;
+
+    case CONTROL_AUTOCYCLE:
+      autoCycle = (value != 0);
+      cycleMillis = currentMillis;
+      controlChanged();
+      break;
+
+    case CONTROL_PALETTE:
+      selectPalette(value & 7);
+      break;
+
+    case CONTROL_DELAY:
+      effectDelay = value;
+      break;
+  }
+
+  controlStatus();
+}
+
+// Take one byte of a command packet
+void controlByte(byte data) {
+  if (controlReceived == 0) {
+    if (data == CONTROL_START) controlReceived = 1;
+    return;
+  }
+
+  controlPacket[controlReceived - 1] = data;
+  if (++controlReceived < CONTROL_PACKET_SIZE) return;
+
+  controlReceived = 0;
+  if ((byte)(controlPacket[0] + controlPacket[1]) == controlPacket[2]) {
+    controlCommand(controlPacket[0], controlPacket[1]);
+  }
+}
+
+// Parse what has arrived, up to CONTROL_BUDGET bytes
+void controlReceive() {
+  for (byte budget = CONTROL_BUDGET; budget > 0 && CONTROL_PORT.available() > 0; budget--) {
+    byte data = CONTROL_PORT.read();
+
+#ifdef USER_PROGRAMS
+    if (controlReceived == 0 && (vmReceived != 0 || data == VM_LOAD_START)) {
+      vmReceiveByte(data);
+      continue;
+    }
+#endif
+
+    controlByte(data);
+  }
+}
+
+#endif
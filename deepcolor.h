@@ -0,0 +1,180 @@
+// 16 bits per channel working buffer for smooth fades
+// An 8-bit channel faded by 1/256 rounds back to itself, so slow fades like
+// fadeAll(1) stall or step visibly near black. With DEEP_COLOR defined every
+// pixel also has a 16-bit copy in deepLeds[] (8.8, the high byte is the 8-bit
+// value), and fadeAll()/fadeTo() work on that, keeping the fraction.
+//
+// leds[] is still what effects draw into. The kernels below and deepResolve()
+// leave each pixel of leds[] at a value worked out from its deep value and
+// error (deepShown()), so once per loop deepResolve() can tell which pixels an
+// effect has drawn since: anything else replaces the deep value. It then turns
+// the deep buffer back into leds[], carrying the part each pixel could not
+// show over to the next show() as a per channel error (temporal error
+// diffusion), so fractions average out over a few frames instead of being lost.
+//
+// fadeAll(), fadeTo(), blurAll() and raster.h's anti-aliased lines keep the
+// fraction, so trails that fade and blur stay smooth. A pixel that any other
+// drawing changes, a fadeToBlackBy() or += on leds[] included, starts again
+// from its 8-bit value.
+//
+// Costs NUM_LEDS * 9 bytes of RAM, more than the 2K AVR boards have; on those
+// memstats.h stops the build. tools/host/deeptest prints the RAM and the time
+// each kernel takes against its 8-bit version.
+
+#ifdef DEEP_COLOR
+
+struct CRGB16 {
+  uint16_t r;
+  uint16_t g;
+  uint16_t b;
+};
+
+CRGB16 deepLeds[NUM_LEDS];
+CRGB deepError[NUM_LEDS]; // fraction carried to the next frame, per channel
+
+// What a channel of leds[] holds while the effect leaves it alone: the whole
+// part, plus one if the last deepResolve() carried the error up into it. The
+// error is what was left of fraction + old error, which only ends up below
+// the fraction when the sum went past 256 and carried.
+inline uint8_t deepShown(uint16_t deep, uint8_t error) {
+  byte whole = deep >> 8;
+  if (whole < 255 && error < (byte)deep) whole++;
+  return whole;
+}
+
+// Set a channel of leds[] to what deepResolve() expects to find there
+inline void deepShow(uint8_t &shown, uint16_t deep, uint8_t error) {
+  shown = deepShown(deep, error);
+}
+
+// Take a channel the effect drew over since the last frame
+inline void deepTake(uint16_t &deep, uint8_t shown, uint8_t &error) {
+  if (shown != deepShown(deep, error)) {
+    deep = shown << 8;
+    error = 0;
+  }
+}
+
+inline void deepTake(uint16_t i) {
+  deepTake(deepLeds[i].r, leds[i].r, deepError[i].r);
+  deepTake(deepLeds[i].g, leds[i].g, deepError[i].g);
+  deepTake(deepLeds[i].b, leds[i].b, deepError[i].b);
+}
+
+// Set a pixel of leds[] to what deepResolve() expects to find there
+inline void deepShow(uint16_t i) {
+  deepShow(leds[i].r, deepLeds[i].r, deepError[i].r);
+  deepShow(leds[i].g, deepLeds[i].g, deepError[i].g);
+  deepShow(leds[i].b, deepLeds[i].b, deepError[i].b);
+}
+
+// deep = deep * (scale + 1) / 256 per channel, what nscale8() does to 8 bits
+inline void deepScale(uint16_t i, byte scale) {
+  deepTake(i); // fadeTo() runs after the effect has drawn
+  CRGB16 &deep = deepLeds[i];
+  uint16_t factor = scale + 1;
+  deep.r = ((uint32_t)deep.r * factor) >> 8;
+  deep.g = ((uint32_t)deep.g * factor) >> 8;
+  deep.b = ((uint32_t)deep.b * factor) >> 8;
+  deepShow(i);
+}
+
+// OR an 8-bit color into the whole part, so nothing fades below it
+inline void deepFloor(uint16_t i, CRGB color) {
+  CRGB16 &deep = deepLeds[i];
+  deep.r |= color.r << 8;
+  deep.g |= color.g << 8;
+  deep.b |= color.b << 8;
+  deepShow(i);
+}
+
+inline uint16_t deepAddChannel(uint16_t deep, uint16_t add) {
+  uint16_t sum = deep + add;
+  return (sum < deep) ? 0xFFFF : sum;
+}
+
+// Saturating add of an 8-bit color
+inline void deepAdd(uint16_t i, CRGB color) {
+  deepTake(i);
+  CRGB16 &deep = deepLeds[i];
+  deep.r = deepAddChannel(deep.r, color.r << 8);
+  deep.g = deepAddChannel(deep.g, color.g << 8);
+  deep.b = deepAddChannel(deep.b, color.b << 8);
+  deepShow(i);
+}
+
+inline uint16_t deepBlendChannel(uint16_t deep, byte value, byte amount) {
+  int32_t delta = (int32_t)(value << 8) - deep;
+  return deep + ((delta * amount) >> 8);
+}
+
+// Move amount/256 of the way to an 8-bit color, what nblend() does to 8 bits
+inline void deepBlend(uint16_t i, CRGB color, byte amount) {
+  deepTake(i);
+  CRGB16 &deep = deepLeds[i];
+  deep.r = deepBlendChannel(deep.r, color.r, amount);
+  deep.g = deepBlendChannel(deep.g, color.g, amount);
+  deep.b = deepBlendChannel(deep.b, color.b, amount);
+  deepShow(i);
+}
+
+inline uint16_t deepPart(uint16_t deep, uint16_t factor) {
+  return ((uint32_t)deep * factor) >> 8;
+}
+
+// blur1d() along one row (across) or column: each pixel keeps 255 - amount of
+// itself and gives amount / 2 to each neighbour
+void deepBlurLine(byte line, boolean across, byte amount) {
+  byte length = across ? kMatrixWidth : kMatrixHeight;
+  uint16_t keep = 256 - amount;
+  uint16_t seep = (amount >> 1) + 1;
+  CRGB16 carry = {0, 0, 0};
+  CRGB16 *previous = NULL;
+  for (byte n = 0; n < length; n++) {
+    CRGB16 &deep = deepLeds[across ? XY(n, line) : XY(line, n)];
+    CRGB16 part = {deepPart(deep.r, seep), deepPart(deep.g, seep), deepPart(deep.b, seep)};
+    deep.r = deepAddChannel(deepPart(deep.r, keep), carry.r);
+    deep.g = deepAddChannel(deepPart(deep.g, keep), carry.g);
+    deep.b = deepAddChannel(deepPart(deep.b, keep), carry.b);
+    if (previous) {
+      previous->r = deepAddChannel(previous->r, part.r);
+      previous->g = deepAddChannel(previous->g, part.g);
+      previous->b = deepAddChannel(previous->b, part.b);
+    }
+    carry = part;
+    previous = &deep;
+  }
+}
+
+// blur2d() on the deep buffer
+void deepBlur2d(byte amount) {
+  for (uint16_t i = 0; i < NUM_LEDS; i++) deepTake(i);
+  for (byte y = 0; y < kMatrixHeight; y++) deepBlurLine(y, true, amount);
+  for (byte x = 0; x < kMatrixWidth; x++) deepBlurLine(x, false, amount);
+  for (uint16_t i = 0; i < NUM_LEDS; i++) deepShow(i);
+}
+
+// Take a channel the effect drew over, then dither the deep value into it
+inline void deepResolveChannel(uint16_t &deep, uint8_t &shown, uint8_t &error) {
+  deepTake(deep, shown, error);
+
+  uint16_t sum = deep + error;
+  if (sum < deep) {
+    shown = 255; // past the top, nothing to carry
+    error = 0;
+  } else {
+    shown = sum >> 8;
+    error = sum;
+  }
+}
+
+// Call once per frame, before overlays are drawn and the frame is shown
+void deepResolve() {
+  for (uint16_t i = 0; i < NUM_LEDS; i++) {
+    deepResolveChannel(deepLeds[i].r, leds[i].r, deepError[i].r);
+    deepResolveChannel(deepLeds[i].g, leds[i].g, deepError[i].g);
+    deepResolveChannel(deepLeds[i].b, leds[i].b, deepError[i].b);
+  }
+}
+
+#endif
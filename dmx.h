@@ -0,0 +1,254 @@
+// E1.31 (sACN) and Art-Net receiver for boards on a WiFi network
+// With DMX_RECEIVER defined the board listens for both protocols on their
+// usual UDP ports. Universes carry the canvas row by row, left to right, three
+// channels (red, green, blue) per pixel and DMX_UNIVERSE_PIXELS pixels each,
+// so a 16x16 canvas takes 2 universes at the default of 170, or 3 at 96
+// (six rows) per universe. Set the sender up the same way.
+//
+// Pixel data is read from the network stack straight into leds[] through
+// XY(), without a second frame buffer. A packet whose sequence number is
+// behind the last one of its universe is dropped before anything is written.
+// Senders number each frame's packets the same in every universe, so the
+// sequence number also tells which frame a packet belongs to: a newer one
+// abandons a frame that has lost a packet, and a frame is only shown once
+// every universe has arrived. For senders that do not, a universe arriving
+// twice starts a new frame instead.
+//
+// While packets keep arriving they replace the effects. After DMX_TIMEOUT
+// without any the effects start again. Senders must send unicast to the
+// board's address; tools/dmxsend.py is a test sender.
+//
+// On Linux and macOS the same receiver listens on a plain UDP socket, so the
+// host build (tools/host/dmxtest.py) can be fed from dmxsend.py over localhost.
+
+#ifdef DMX_RECEIVER
+
+#if defined(ESP32) || defined(ESP8266)
+#define DMX_WIFI
+#endif
+
+#if defined(ESP32)
+#include <WiFi.h>
+#include <WiFiUdp.h>
+#elif defined(ESP8266)
+#include <ESP8266WiFi.h>
+#include <WiFiUdp.h>
+#elif defined(__linux__) || defined(__APPLE__)
+#include <sys/socket.h>
+#include <netinet/in.h>
+#else
+#error "DMX_RECEIVER needs a WiFi board (ESP32 or ESP8266), or the host build"
+#endif
+
+#define DMX_SSID "network"
+#define DMX_PASSWORD "password"
+#define DMX_FIRST_UNIVERSE 1   // Art-Net senders often count from 0
+#ifndef DMX_UNIVERSE_PIXELS
+#define DMX_UNIVERSE_PIXELS 170 // at most 170, 512 channels / 3; 96 splits 16x16 into 3 universes
+#endif
+#define DMX_TIMEOUT 2000
+
+#define DMX_UNIVERSES ((NUM_LEDS + DMX_UNIVERSE_PIXELS - 1) / DMX_UNIVERSE_PIXELS)
+#define DMX_NO_SEQUENCE 0x100
+
+#define ARTNET_PORT 6454
+#define ARTNET_HEADER_SIZE 18
+#define SACN_PORT 5568
+#define SACN_HEADER_SIZE 126
+
+static_assert(DMX_UNIVERSE_PIXELS <= 170, "a universe holds at most 170 pixels");
+
+#ifdef DMX_WIFI
+typedef WiFiUDP DmxUdp;
+#else
+// The calls the receiver makes on WiFiUDP, on a POSIX socket
+class DmxUdp {
+  int fd = -1;
+  byte packet[SACN_HEADER_SIZE + 512];
+  int size = 0;
+  int position = 0;
+
+ public:
+  void begin(uint16_t port) {
+    fd = socket(AF_INET, SOCK_DGRAM, 0);
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (fd < 0 || bind(fd, (sockaddr *)&address, sizeof(address)) < 0) perror("dmx socket");
+  }
+
+  int parsePacket() {
+    position = 0;
+    size = fd < 0 ? 0 : recv(fd, packet, sizeof(packet), MSG_DONTWAIT);
+    if (size < 0) size = 0;
+    return size;
+  }
+
+  int read(uint8_t *dest, size_t count) {
+    if (count > (size_t)(size - position)) count = size - position;
+    memcpy(dest, packet + position, count);
+    position += count;
+    return count;
+  }
+};
+#endif
+
+DmxUdp dmxArtnet;
+DmxUdp dmxSacn;
+byte dmxHeader[SACN_HEADER_SIZE];
+
+uint16_t dmxSequence[DMX_UNIVERSES];         // last sequence number per universe, or DMX_NO_SEQUENCE
+byte dmxArrived[(DMX_UNIVERSES + 7) / 8];    // universes of the current frame received so far
+uint16_t dmxArrivedCount = 0;
+byte dmxFrameKey = 0;                        // sequence number of the frame being put together
+boolean dmxKeyed = true;                     // the sender numbers every universe of a frame the same
+uint16_t dmxMisses = 0;                      // packets since the last complete frame
+boolean dmxStreaming = false;
+unsigned long dmxHeard = 0;                  // time of the last packet used
+uint16_t dmxFrames = 0;                      // complete frames shown
+uint16_t dmxDropped = 0;                     // packets out of sequence
+
+void dmxNewFrame() {
+  memset(dmxArrived, 0, sizeof(dmxArrived));
+  dmxArrivedCount = 0;
+}
+
+void dmxSetup() {
+  for (uint16_t u = 0; u < DMX_UNIVERSES; u++) dmxSequence[u] = DMX_NO_SEQUENCE;
+  dmxNewFrame();
+
+#ifdef DMX_WIFI
+  // the sockets work before the connection is up, effects run meanwhile
+  WiFi.mode(WIFI_STA);
+  WiFi.begin(DMX_SSID, DMX_PASSWORD);
+#endif
+  dmxArtnet.begin(ARTNET_PORT);
+  dmxSacn.begin(SACN_PORT);
+}
+
+// E1.31 rule: a sequence number up to 20 behind the last accepted one is stale
+boolean dmxInSequence(uint16_t universe, byte sequence) {
+  if (dmxSequence[universe] != DMX_NO_SEQUENCE) {
+    int8_t ahead = sequence - dmxSequence[universe];
+    if (ahead <= 0 && ahead > -20) {
+      dmxDropped++;
+      return false;
+    }
+  }
+  return true;
+}
+
+// Decide whether a packet belongs to the frame being put together,
+// starting a new frame if it is newer, false if it is part of an older one
+boolean dmxJoinFrame(uint16_t universe, byte sequence, boolean numbered) {
+  if (dmxKeyed && numbered) {
+    int8_t ahead = sequence - dmxFrameKey;
+    if (ahead < 0 && dmxArrivedCount > 0) return false;
+    if (ahead > 0 || dmxArrivedCount == 0) {
+      dmxNewFrame();
+      dmxFrameKey = sequence;
+    }
+  }
+
+  byte bit = 1 << (universe & 7);
+  if (dmxArrived[universe >> 3] & bit) dmxNewFrame(); // unnumbered, the frame lost a universe
+  dmxArrived[universe >> 3] |= bit;
+  return true;
+}
+
+// Read a universe's pixels from the packet into leds[]
+void dmxReadPixels(DmxUdp &udp, uint16_t universe, uint16_t channels) {
+  uint16_t first = universe * DMX_UNIVERSE_PIXELS;
+  uint16_t count = channels / 3;
+  if (count > DMX_UNIVERSE_PIXELS) count = DMX_UNIVERSE_PIXELS;
+  if (count > NUM_LEDS - first) count = NUM_LEDS - first;
+
+  if (xyRowsContiguous()) {
+    // canvas order is LED order, read the whole run at once
+    udp.read((uint8_t *)&leds[first], count * 3);
+    return;
+  }
+
+  for (uint16_t p = first; p < first + count; p++) {
+    udp.read((uint8_t *)&leds[XY(p % kMatrixWidth, p / kMatrixWidth)], 3);
+  }
+}
+
+// Count a universe in, true when it completes the frame
+boolean dmxUniverseArrived() {
+  dmxHeard = currentMillis;
+  if (!dmxStreaming) {
+    dmxStreaming = true;
+    fadingActive = false;
+  }
+
+  if (++dmxArrivedCount < DMX_UNIVERSES) {
+    // a sender that numbers its universes differently never completes a frame
+    if (++dmxMisses > DMX_UNIVERSES * 16) dmxKeyed = false;
+    return false;
+  }
+  dmxNewFrame();
+  dmxMisses = 0;
+  dmxFrames++;
+  return true;
+}
+
+// Read a checked packet into its universe, true when it completes a frame
+// Art-Net sends sequence 0 when it does not number its packets
+boolean dmxUniverse(DmxUdp &udp, uint16_t universe, byte sequence, boolean numbered, uint16_t channels) {
+  if (universe >= DMX_UNIVERSES) return false;
+  if (numbered && !dmxInSequence(universe, sequence)) return false;
+  if (!dmxJoinFrame(universe, sequence, numbered)) return false;
+  if (numbered) dmxSequence[universe] = sequence; // only once the packet is taken
+
+  dmxReadPixels(udp, universe, channels);
+  return dmxUniverseArrived();
+}
+
+// Handle the pending Art-Net packet, true when it completes a frame
+boolean dmxArtnetPacket() {
+  if (dmxArtnet.read(dmxHeader, ARTNET_HEADER_SIZE) != ARTNET_HEADER_SIZE) return false;
+  if (memcmp(dmxHeader, "Art-Net", 8) != 0) return false;
+  if (dmxHeader[8] != 0x00 || dmxHeader[9] != 0x50) return false; // OpDmx
+
+  uint16_t universe = (dmxHeader[14] | (dmxHeader[15] << 8)) - DMX_FIRST_UNIVERSE;
+  return dmxUniverse(dmxArtnet, universe, dmxHeader[12], dmxHeader[12] != 0, (dmxHeader[16] << 8) | dmxHeader[17]);
+}
+
+// Handle the pending E1.31 packet, true when it completes a frame
+boolean dmxSacnPacket() {
+  if (dmxSacn.read(dmxHeader, SACN_HEADER_SIZE) != SACN_HEADER_SIZE) return false;
+  if (memcmp(&dmxHeader[4], "ASC-E1.17\0\0\0", 12) != 0) return false;
+  if (dmxHeader[21] != 0x04 || dmxHeader[43] != 0x02) return false;   // root and framing vectors for DMX data
+  if (dmxHeader[112] & 0xC0) return false;                            // preview data or stream terminated
+  if (dmxHeader[117] != 0x02 || dmxHeader[125] != 0) return false;    // set property, DMX start code 0
+
+  uint16_t universe = ((dmxHeader[113] << 8) | dmxHeader[114]) - DMX_FIRST_UNIVERSE;
+  uint16_t channels = ((dmxHeader[123] << 8) | dmxHeader[124]) - 1; // the count includes the start code
+  return dmxUniverse(dmxSacn, universe, dmxHeader[111], true, channels);
+}
+
+// Take in the packets that have arrived, true once a whole frame is in leds[]
+boolean dmxReceive() {
+  while (dmxArtnet.parsePacket() > 0) {
+    if (dmxArtnetPacket()) return true;
+  }
+  while (dmxSacn.parsePacket() > 0) {
+    if (dmxSacnPacket()) return true;
+  }
+  return false;
+}
+
+// True while network frames own leds[]
+boolean dmxActive() {
+  if (dmxStreaming && currentMillis - dmxHeard >= DMX_TIMEOUT) {
+    dmxStreaming = false;
+    dmxNewFrame();
+    dmxKeyed = true;
+    effectInit = false; // draw the effect over the last network frame from scratch
+  }
+  return dmxStreaming;
+}
+
+#endif
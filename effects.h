@@ -4,34 +4,46 @@
 //    * Check effectInit, if false then init any required settings and set effectInit true
 //    * Set effectDelay (the time in milliseconds until the next run of this effect)
 //    * All animation should be controlled with counters and effectDelay, no delay() or loops
+//    * Advance continuous counters by frameStep() so late frames do not slow the animation
 //    * Pixel data should be written using leds[XY(x,y)] to map coordinates to the RGB Shades layout
 
 // Triple Sine Waves
 void threeSine() {
 
-  static byte sineOffset = 0; // counter for current position of sine waves
+  static uint16_t sinePhase = 0; // position of the sine waves, 8.8 fixed point
 
   // startup tasks
   if (effectInit == false) {
     effectInit = true;
     effectDelay = 20;
+    keyframeReset();
   }
 
-  // Draw one frame of the animation into the LED array
-  for (byte x = 0; x < kMatrixWidth; x++) {
-    for (int y = 0; y < kMatrixHeight; y++) {
+  if (keyframeInBetween()) return;
 
-      // Calculate "sine" waves with varying periods
-      // sin8 is used for speed; cos8, quadwave8, or triwave8 would also work here
-      byte sinDistanceR = qmul8(abs(y * (255 / kMatrixHeight) - sin8(sineOffset * 9 + x * 16)), 2);
-      byte sinDistanceG = qmul8(abs(y * (255 / kMatrixHeight) - sin8(sineOffset * 10 + x * 16)), 2);
-      byte sinDistanceB = qmul8(abs(y * (255 / kMatrixHeight) - sin8(sineOffset * 11 + x * 16)), 2);
+  byte sineOffset = sinePhase >> 8;
 
-      leds[XY(x, y)] = CRGB(255 - sinDistanceR, 255 - sinDistanceG, 255 - sinDistanceB);
-    }
+  // Calculate "sine" waves with varying periods, they only change along x
+  // sin8 is used for speed; cos8, quadwave8, or triwave8 would also work here
+  byte sineR[FIELD_WIDTH], sineG[FIELD_WIDTH], sineB[FIELD_WIDTH];
+  for (byte x = 0; x < FIELD_WIDTH; x += FIELD_STEP) {
+    sineR[x] = sin8(sineOffset * 9 + x * 16);
+    sineG[x] = sin8(sineOffset * 10 + x * 16);
+    sineB[x] = sin8(sineOffset * 11 + x * 16);
   }
 
-  sineOffset++; // byte will wrap from 255 to 0, matching sin8 0-255 cycle
+  // Draw one frame of the animation into the LED array
+  byte rowLevel;
+  shadeField([&](byte y) { rowLevel = y * (255 / kMatrixHeight); },
+  [&](byte x, byte /*y*/) {
+    byte sinDistanceR = qmul8(abs(rowLevel - sineR[x]), 2);
+    byte sinDistanceG = qmul8(abs(rowLevel - sineG[x]), 2);
+    byte sinDistanceB = qmul8(abs(rowLevel - sineB[x]), 2);
+    return CRGB(255 - sinDistanceR, 255 - sinDistanceG, 255 - sinDistanceB);
+  });
+
+  sinePhase += frameStep(256); // one step per frame, wraps to match the sin8 0-255 cycle
+  keyframeCapture();
 
 }
 
@@ -39,29 +51,36 @@ void threeSine() {
 // RGB Plasma
 void plasma() {
 
-  static byte offset  = 0; // counter for radial color wave motion
+  static uint16_t offsetPhase = 0; // radial color wave motion, 8.8 fixed point
   static int plasVector = 0; // counter for orbiting plasma center
 
   // startup tasks
   if (effectInit == false) {
     effectInit = true;
     effectDelay = 10;
+    keyframeReset();
   }
 
+  if (keyframeInBetween()) return;
+
+  byte offset = offsetPhase >> 8;
+
   // Calculate current center of plasma pattern (can be offscreen)
   int xOffset = cos8(plasVector / 256);
   int yOffset = sin8(plasVector / 256);
 
   // Draw one frame of the animation into the LED array
-  for (int x = 0; x < kMatrixWidth; x++) {
-    for (int y = 0; y < kMatrixHeight; y++) {
-      byte color = sin8(sqrt(sq(((float)x - 7.5) * 10 + xOffset - 127) + sq(((float)y - 2) * 10 + yOffset - 127)) + offset);
-      leds[XY(x, y)] = CHSV(color, 255, 255);
+  for (int x = 0; x < FIELD_WIDTH; x += FIELD_STEP) {
+    for (int y = 0; y < FIELD_HEIGHT; y += FIELD_STEP) {
+      byte color = sin8(sqrt(sq(((float)x - (kMatrixWidth - 1) / 2.0) * 10 + xOffset - 127) + sq(((float)y - 2) * 10 + yOffset - 127)) + offset);
+      fieldPixel(x, y) = CHSV(color, 255, 255);
     }
   }
+  fieldUpscale();
 
-  offset++; // wraps at 255 for sin8
-  plasVector += 16; // using an int for slower orbit (wraps at 65536)
+  offsetPhase += frameStep(256); // wraps at 255 for sin8
+  plasVector += frameStep(16); // using an int for slower orbit (wraps at 65536)
+  keyframeCapture();
 
 }
 
@@ -69,15 +88,17 @@ void plasma() {
 // Scanning pattern left/right, uses global hue cycle
 void rider() {
 
-  static byte riderPos = 0;
+  static uint16_t riderPhase = 0; // 8.8 fixed point
 
   // startup tasks
   if (effectInit == false) {
     effectInit = true;
     effectDelay = 5;
-    riderPos = 0;
+    riderPhase = 0;
   }
 
+  byte riderPos = riderPhase >> 8;
+
   // Draw one frame of the animation into the LED array
   for (byte x = 0; x < kMatrixWidth; x++) {
     int brightness = abs(x * (256 / kMatrixWidth) - triwave8(riderPos) * 2 + 127) * 3;
@@ -89,7 +110,7 @@ void rider() {
     }
   }
 
-  riderPos++; // byte wraps to 0 at 255, triwave8 is also 0-255 periodic
+  riderPhase += frameStep(256); // wraps to 0 at 255, triwave8 is also 0-255 periodic
 }
 
 
@@ -102,11 +123,13 @@ void glitter() {
     effectDelay = 15;
   }
 
-  // Draw one frame of the animation into the LED array
-  for (int x = 0; x < kMatrixWidth; x++) {
-    for (int y = 0; y < kMatrixHeight; y++) {
-      leds[XY(x, y)] = CHSV(cycleHue, 255, random8(5) * 63);
-    }
+  // five brightness levels of the hue, one picked at random for every pixel
+  CRGB levels[5];
+  for (byte i = 0; i < 5; i++) levels[i] = CHSV(cycleHue, 255, i * 63);
+
+  rngFill(effectScratch, NUM_LEDS); // one random byte per pixel
+  for (uint16_t i = 0; i < NUM_LEDS; i++) {
+    leds[i] = levels[rngMap(effectScratch[i], 5)];
   }
 }
 
@@ -117,6 +140,7 @@ void colorFill() {
   static byte currentColor = 0;
   static byte currentRow = 0;
   static byte currentDirection = 0;
+  static uint16_t fillCarry = 0;
 
   // startup tasks
   if (effectInit == false) {
@@ -125,39 +149,42 @@ void colorFill() {
     currentColor = 0;
     currentRow = 0;
     currentDirection = 0;
+    fillCarry = 0;
     currentPalette = RainbowColors_p;
   }
 
-  // test a bitmask to fill up or down when currentDirection is 0 or 2 (0b00 or 0b10)
-  if (!(currentDirection & 1)) {
-    effectDelay = 45; // slower since vertical has fewer pixels
-    for (byte x = 0; x < kMatrixWidth; x++) {
+  // one row or column per design frame
+  for (byte steps = frameSteps(fillCarry); steps > 0; steps--) {
+
+    // test a bitmask to fill up or down when currentDirection is 0 or 2 (0b00 or 0b10)
+    if (!(currentDirection & 1)) {
+      effectDelay = 45; // slower since vertical has fewer pixels
       byte y = currentRow;
       if (currentDirection == 2) y = kMatrixHeight - 1 - currentRow;
-      leds[XY(x, y)] = currentPalette[currentColor];
+      fillRect(0, y, kMatrixWidth, 1, currentPalette[currentColor]);
     }
-  }
 
-  // test a bitmask to fill left or right when currentDirection is 1 or 3 (0b01 or 0b11)
-  if (currentDirection & 1) {
-    effectDelay = 20; // faster since horizontal has more pixels
-    for (byte y = 0; y < kMatrixHeight; y++) {
+    // test a bitmask to fill left or right when currentDirection is 1 or 3 (0b01 or 0b11)
+    if (currentDirection & 1) {
+      effectDelay = 20; // faster since horizontal has more pixels
       byte x = currentRow;
       if (currentDirection == 3) x = kMatrixWidth - 1 - currentRow;
-      leds[XY(x, y)] = currentPalette[currentColor];
+      fillRect(x, 0, 1, kMatrixHeight, currentPalette[currentColor]);
     }
-  }
-
-  currentRow++;
 
-  // detect when a fill is complete, change color and direction
-  if ((!(currentDirection & 1) && currentRow >= kMatrixHeight) || ((currentDirection & 1) && currentRow >= kMatrixWidth)) {
-    currentRow = 0;
-    currentColor += random8(3, 6);
-    if (currentColor > 15) currentColor -= 16;
-    currentDirection++;
-    if (currentDirection > 3) currentDirection = 0;
-    effectDelay = 300; // wait a little bit longer after completing a fill
+    currentRow++;
+
+    // detect when a fill is complete, change color and direction
+    if ((!(currentDirection & 1) && currentRow >= kMatrixHeight) || ((currentDirection & 1) && currentRow >= kMatrixWidth)) {
+      currentRow = 0;
+      currentColor += random8(3, 6);
+      if (currentColor > 15) currentColor -= 16;
+      currentDirection++;
+      if (currentDirection > 3) currentDirection = 0;
+      effectDelay = 300; // wait a little bit longer after completing a fill
+      fillCarry = 0;
+      break;
+    }
   }
 }
 
@@ -170,36 +197,35 @@ void threeDee() {
     effectDelay = 50;
   }
 
-  for (byte x = 0; x < kMatrixWidth; x++) {
-    for (byte y = 0; y < kMatrixHeight; y++) {
-      if (x < 7) {
-        leds[XY(x, y)] = CRGB::Blue;
-      } else if (x > 8) {
-        leds[XY(x, y)] = CRGB::Red;
-      } else {
-        leds[XY(x, y)] = CRGB::Black;
-      }
-    }
-  }
+  // left lens, bridge, right lens
+  fillRect(0, 0, kMatrixWidth / 2 - 1, kMatrixHeight, CRGB::Blue);
+  fillRect(kMatrixWidth / 2 - 1, 0, 2, kMatrixHeight, CRGB::Black);
+  fillRect(kMatrixWidth / 2 + 1, 0, kMatrixWidth - kMatrixWidth / 2 - 1, kMatrixHeight, CRGB::Red);
 
-  leds[XY(6, 0)] = CRGB::Black;
-  leds[XY(9, 0)] = CRGB::Black;
+  leds[XY(kMatrixWidth / 2 - 2, 0)] = CRGB::Black;
+  leds[XY(kMatrixWidth / 2 + 1, 0)] = CRGB::Black;
 }
 
 // Random pixels scroll sideways, uses current hue
 #define rainDir 0
 void sideRain() {
 
+  static uint16_t rainCarry = 0;
+
   // startup tasks
   if (effectInit == false) {
     effectInit = true;
     effectDelay = 30;
+    rainCarry = 0;
   }
 
-  scrollArray(rainDir);
-  byte randPixel = random8(kMatrixHeight);
-  for (byte y = 0; y < kMatrixHeight; y++) leds[XY((kMatrixWidth - 1) * rainDir, y)] = CRGB::Black;
-  leds[XY((kMatrixWidth - 1)*rainDir, randPixel)] = CHSV(cycleHue, 255, 255);
+  // one column per design frame
+  for (byte steps = frameSteps(rainCarry); steps > 0; steps--) {
+    scrollArray(rainDir);
+    byte randPixel = random8(kMatrixHeight);
+    for (byte y = 0; y < kMatrixHeight; y++) leds[XY((kMatrixWidth - 1) * rainDir, y)] = CRGB::Black;
+    leds[XY((kMatrixWidth - 1)*rainDir, randPixel)] = CHSV(cycleHue, 255, 255);
+  }
 
 }
 
@@ -207,6 +233,8 @@ void sideRain() {
 // Use with the fadeAll function to allow old pixels to decay
 void confetti() {
 
+  static uint16_t confettiCarry = 0;
+
   // startup tasks
   if (effectInit == false) {
     effectInit = true;
@@ -214,12 +242,13 @@ void confetti() {
     selectRandomPalette();
     fadingActive = true;
     fadeBaseColor = CRGB::Black;
+    confettiCarry = 0;
   }
 
-  // scatter random colored pixels at several random coordinates
-  for (byte i = 0; i < 4; i++) {
-    leds[XY(random16(kMatrixWidth), random8(kMatrixHeight))] = ColorFromPalette(currentPalette, random16(255), 255); //CHSV(random16(255), 255, 255);
-    random16_add_entropy(1);
+  // scatter random colored pixels at several random coordinates, four per design frame
+  byte count = 4 * frameSteps(confettiCarry);
+  for (byte i = 0; i < count; i++) {
+    leds[XY(rngBelow8(kMatrixWidth), rngBelow8(kMatrixHeight))] = ColorFromPalette(currentPalette, rngBelow8(255), 255); //CHSV(random16(255), 255, 255);
   }
 }
 
@@ -227,7 +256,7 @@ void confetti() {
 // Draw slanting bars scrolling across the array, uses current hue
 void slantBars() {
 
-  static byte slantPos = 0;
+  static uint16_t slantPhase = 0; // 8.8 fixed point
 
   // startup tasks
   if (effectInit == false) {
@@ -235,13 +264,13 @@ void slantBars() {
     effectDelay = 5;
   }
 
-  for (byte x = 0; x < kMatrixWidth; x++) {
-    for (byte y = 0; y < kMatrixHeight; y++) {
-      leds[XY(x, y)] = CHSV(cycleHue, 255, quadwave8(x * 16 + y * 16 + slantPos));
-    }
-  }
+  byte slantPos = slantPhase >> 8;
+  byte rowPos;
+
+  shade([&](byte y) { rowPos = y * 16 + slantPos; },
+  [&](byte x, byte /*y*/) { return CHSV(cycleHue, 255, quadwave8(x * 16 + rowPos)); });
 
-  slantPos -= 4;
+  slantPhase -= frameStep(4 * 256);
 }
 
 
@@ -256,6 +285,7 @@ void scrollText(byte message, byte style, CRGB fgColor, CRGB bgColor, byte repea
   static CRGB currentColor;
   static byte currentWordCount = 0;
   static byte currentChar;
+  static uint16_t scrollCarry = 0;
 
   // startup tasks
   if (effectInit == false) {
@@ -263,6 +293,7 @@ void scrollText(byte message, byte style, CRGB fgColor, CRGB bgColor, byte repea
     effectDelay = 35;
     currentMessageChar = 0;
     currentCharColumn = 0;
+    scrollCarry = 0;
     selectFlashString(message);
     repCount = repeats;
     currentChar = loadStringChar(message, currentMessageChar);
@@ -284,53 +315,56 @@ void scrollText(byte message, byte style, CRGB fgColor, CRGB bgColor, byte repea
     fillAll(CRGB::Black);
   }
 
-  CRGB pixelColor;
+  // one column per design frame, until the message ends and the pattern changes
+  for (byte steps = frameSteps(scrollCarry); steps > 0 && effectInit; steps--) {
+    CRGB pixelColor;
 
-  scrollArray(1);
-  if (style == RAINBOW) paletteCycle += 10;
+    scrollArray(1);
+    if (style == RAINBOW) paletteCycle += 10;
 
-  for (byte y = 0; y < 16; y++) { // characters are 5 pixels tall
-    if ((bitRead(charBuffer[currentCharColumn], y) == 1) && currentCharColumn < 5) {
-      if (style == RAINBOW) {
-        pixelColor = ColorFromPalette(currentPalette, paletteCycle + y * 16, 255);
+    for (byte y = 0; y < kMatrixHeight; y++) { // characters are 5 pixels tall
+      if (y < 8 && (bitRead(charBuffer[currentCharColumn], y) == 1) && currentCharColumn < 5) {
+        if (style == RAINBOW) {
+          pixelColor = ColorFromPalette(currentPalette, paletteCycle + y * 16, 255);
+        } else {
+          pixelColor = currentColor;
+        }
       } else {
-        pixelColor = currentColor;
+        pixelColor = bgColor;
       }
-    } else {
-      pixelColor = bgColor;
+      leds[XY(kMatrixWidth - 1, y)] = pixelColor;
     }
-    leds[XY(kMatrixWidth - 1, y)] = pixelColor;
-  }
 
-  currentCharColumn++;
-  if (currentCharColumn > (4 + charSpacing)) {
-    currentCharColumn = 0;
-    currentMessageChar++;
-    char nextChar = loadStringChar(message, currentMessageChar);
-    if (nextChar == 0) { // null character at end of string
-      currentMessageChar = 0;
-      if (repCount > 0) repCount--;
-      if (repCount == 0) cyclePattern();
-      nextChar = loadStringChar(message, currentMessageChar);
-    }
+    currentCharColumn++;
+    if (currentCharColumn > (4 + charSpacing)) {
+      currentCharColumn = 0;
+      currentMessageChar++;
+      char nextChar = loadStringChar(message, currentMessageChar);
+      if (nextChar == 0) { // null character at end of string
+        currentMessageChar = 0;
+        if (repCount > 0) repCount--;
+        if (repCount == 0) cyclePattern();
+        nextChar = loadStringChar(message, currentMessageChar);
+      }
 
 
-    if (currentChar == ' ' && nextChar != ' ') {
-      if (style == PALETTEWORDS) {
-        paletteCycle += 15;
-        currentColor = ColorFromPalette(currentPalette, paletteCycle * 15, 255);
-      } else if (style == CANDYCANE || style == HOLLY) {
-        currentColor = colorCycle(style);
+      if (currentChar == ' ' && nextChar != ' ') {
+        if (style == PALETTEWORDS) {
+          paletteCycle += 15;
+          currentColor = ColorFromPalette(currentPalette, paletteCycle * 15, 255);
+        } else if (style == CANDYCANE || style == HOLLY) {
+          currentColor = colorCycle(style);
+        }
       }
-    }
 
-    if (currentChar != ' ') {
-      if (style == HOLLY2) currentColor = colorCycle(HOLLY);
-    }
+      if (currentChar != ' ') {
+        if (style == HOLLY2) currentColor = colorCycle(HOLLY);
+      }
 
 
-    loadCharBuffer(nextChar);
-    currentChar = nextChar;
+      loadCharBuffer(nextChar);
+      currentChar = nextChar;
+    }
   }
 }
 
@@ -338,8 +372,8 @@ void scrollText(byte message, byte style, CRGB fgColor, CRGB bgColor, byte repea
 // RotatingPlasma
 void spinPlasma() {
 
-  static byte offset  = 0; // counter for radial color wave motion
-  static int plasVector = 0; // counter for orbiting plasma center
+  static uint16_t offsetPhase = 0; // radial color wave motion, 8.8 fixed point
+  static uint16_t plasVector = 0; // orbiting plasma center, 8.8 fixed point
 
   // startup tasks
   if (effectInit == false) {
@@ -347,26 +381,33 @@ void spinPlasma() {
     effectDelay = 10;
     selectRandomPalette();
     fadingActive = false;
+    keyframeReset();
   }
 
+  if (keyframeInBetween()) return;
+
+  byte offset = offsetPhase >> 8;
+
   // Calculate current center of plasma pattern (can be offscreen)
-  int xOffset = (cos8(plasVector) - 127) / 2;
-  int yOffset = (sin8(plasVector) - 127) / 2;
+  int xOffset = (cos8(plasVector >> 8) - 127) / 2;
+  int yOffset = (sin8(plasVector >> 8) - 127) / 2;
 
   //int xOffset = 0;
   //int yOffset = 0;
 
 
   // Draw one frame of the animation into the LED array
-  for (int x = 0; x < kMatrixWidth; x++) {
-    for (int y = 0; y < kMatrixHeight; y++) {
-      byte color = sin8(sqrt(sq(((float)x - 7.5) * 12 + xOffset) + sq(((float)y - 2) * 12 + yOffset)) + offset);
-      leds[XY(x, y)] = ColorFromPalette(currentPalette, color, 255);
+  for (int x = 0; x < FIELD_WIDTH; x += FIELD_STEP) {
+    for (int y = 0; y < FIELD_HEIGHT; y += FIELD_STEP) {
+      byte color = sin8(sqrt(sq(((float)x - (kMatrixWidth - 1) / 2.0) * 12 + xOffset) + sq(((float)y - 2) * 12 + yOffset)) + offset);
+      fieldPixel(x, y) = ColorFromPalette(currentPalette, color, 255);
     }
   }
+  fieldUpscale();
 
-  offset++; // wraps at 255 for sin8
-  plasVector += 1; // using an int for slower orbit (wraps at 65536)
+  offsetPhase += frameStep(256); // wraps at 255 for sin8
+  plasVector += frameStep(256); // orbit one step per frame
+  keyframeCapture();
 
 }
 
@@ -412,7 +453,7 @@ void fireworks() {
 
 
   if (boom) {
-    FastLED.clear();
+    fillAll(CRGB::Black);
     boom = false;
   } else {
     fadeAll(40);
@@ -464,17 +505,10 @@ void xmasThreeDee() {
 
   swap = !swap;
 
-  for (byte x = 0; x < kMatrixWidth; x++) {
-    for (byte y = 0; y < kMatrixHeight; y++) {
-      if (x < 7) {
-        leds[XY(x, y)] = swap ? CRGB::Blue : CRGB::Red;
-      } else if (x > 8) {
-        leds[XY(x, y)] = swap ? CRGB::Red : CRGB::Blue;
-      } else {
-        leds[XY(x, y)] = CRGB::Black;
-      }
-    }
-  }
+  // left lens, bridge, right lens
+  fillRect(0, 0, kMatrixWidth / 2 - 1, kMatrixHeight, swap ? CRGB::Blue : CRGB::Red);
+  fillRect(kMatrixWidth / 2 - 1, 0, 2, kMatrixHeight, CRGB::Black);
+  fillRect(kMatrixWidth / 2 + 1, 0, kMatrixWidth - kMatrixWidth / 2 - 1, kMatrixHeight, swap ? CRGB::Red : CRGB::Blue);
   //  leds[XY(6, 0)] = CRGB::Black;
   //  leds[XY(9, 0)] = CRGB::Black;
 }
@@ -483,7 +517,8 @@ void xmasThreeDee() {
 // Smoothly falling white dots
 void snow() {
 
-  static unsigned int snowCols[kMatrixWidth] = {0};
+  // snow falls along x, one flake per row (matches the old deg() column order)
+  static unsigned int snowCols[kMatrixHeight] = {0};
 
   // startup tasks
   if (effectInit == false) {
@@ -494,19 +529,19 @@ void snow() {
 
   CRGB snowColor = CRGB::White;
 
-  FastLED.clear();
+  fillAll(CRGB::Black);
 
-  for (int i = 0; i < kMatrixWidth; i++) {
+  for (int i = 0; i < kMatrixHeight; i++) {
     if (snowCols[i] > 0) {
-      snowCols[i] += random(4, 16);
+      snowCols[i] += frameStep(rngRange8(4, 16));
     } else {
-      if (random8(0, 100) == 0) snowCols[i] = 1;
+      if (rngBelow16(100 * 256) < frameTicks) snowCols[i] = 1; // one in 100 per design frame
     }
     byte tempY = snowCols[i] >> 8;
     byte tempRem = snowCols[i] & 0xFF;
-    if (tempY <= kMatrixHeight) leds[deg(XY(i, tempY - 1))] = snowColor % dim8_raw(255 - tempRem);
-    if (tempY < kMatrixHeight) leds[deg(XY(i, tempY))] = snowColor % dim8_raw(tempRem);
-    if (tempY > kMatrixHeight) snowCols[i] = 0;
+    if (tempY > 0 && tempY <= kMatrixWidth) leds[XY(tempY - 1, i)] = snowColor % dim8_raw(255 - tempRem);
+    if (tempY < kMatrixWidth) leds[XY(tempY, i)] = snowColor % dim8_raw(tempRem);
+    if (tempY > kMatrixWidth) snowCols[i] = 0;
   }
 }
 
@@ -514,7 +549,7 @@ void snow() {
 // Draw slanting bars scrolling across the array, uses current hue
 void candycaneSlantbars() {
 
-  static byte slantPos = 0;
+  static uint16_t slantPhase = 0; // 8.8 fixed point
 
   // startup tasks
   if (effectInit == false) {
@@ -523,13 +558,13 @@ void candycaneSlantbars() {
     fadingActive = false;
   }
 
-  for (byte x = 0; x < kMatrixWidth; x++) {
-    for (byte y = 0; y < kMatrixHeight; y++) {
-      leds[XY(x, y)] = blend(CRGB::Red, CRGB::White, cubicwave8(x * 32 + y * 32 + slantPos));
-    }
-  }
+  byte slantPos = slantPhase >> 8;
+  byte rowPos;
+
+  shade([&](byte y) { rowPos = y * 32 + slantPos; },
+  [&](byte x, byte /*y*/) { return blend(CRGB::Red, CRGB::White, cubicwave8(x * 32 + rowPos)); });
 
-  slantPos -= 4;
+  slantPhase -= frameStep(4 * 256);
 
 }
 
@@ -543,13 +578,12 @@ DEFINE_GRADIENT_PALETTE( checkermap_gp) {
 };
 
 void flash() {
-  uint8_t number = random8();
-  fadeToBlackBy(leds, NUM_LEDS, 255);
-  leds[number] = CRGB::White;
+  fillAll(CRGB::Black);
+  leds[rngBelow16(NUM_LEDS)] = CRGB::White;
 }
 
 void checkerboard() {
-  static byte checkerFader = 0;
+  static uint16_t checkerPhase = 0; // 8.8 fixed point
 
   // startup tasks
   if (effectInit == false) {
@@ -559,19 +593,16 @@ void checkerboard() {
     fadingActive = false;
   }
 
-  checkerFader += 2;
+  checkerPhase += frameStep(2 * 256);
+  byte checkerFader = checkerPhase >> 8;
 
 
   CRGB colorOne = ColorFromPalette(currentPalette, checkerFader);
   CRGB colorTwo = ColorFromPalette(currentPalette, checkerFader + 64);
 
-  for (byte x = 0; x < kMatrixWidth; x++) {
-    for (byte y = 0; y < kMatrixHeight; y++) {
-      leds[XY(x, y)] = (((x % 2) + y) % 2) ? colorOne : colorTwo;
-      //leds[XY(x,y)] = (y % 2) ? colorOne : colorTwo;
-      //leds[XY(x,y)] = (x % 2) ? colorOne : colorTwo;
-    }
-  }
+  byte rowOdd;
+  shade([&](byte y) { rowOdd = y & 1; },
+  [&](byte x, byte /*y*/) { return ((x ^ rowOdd) & 1) ? colorOne : colorTwo; });
 }
 
 void blurpattern()
@@ -587,7 +618,7 @@ void blurpattern()
   // blur it repeatedly.  Since the blurring is 'lossy', there's
   // an automatic trend toward black -- by design.
   uint8_t blurAmount = beatsin8(2, 10, 255);
-  blur2d( leds, kMatrixWidth, kMatrixHeight, blurAmount);
+  blurAll(blurAmount);
 
   // Use two out-of-sync sine waves
   uint8_t  i = beatsin8( 27, 0, kMatrixHeight);
@@ -597,7 +628,7 @@ void blurpattern()
   uint8_t nj = (kMatrixWidth - 1) - j;
 
   // The color of each point shifts over time, each at a different speed.
-  uint16_t ms = millis();
+  uint16_t ms = currentMillis;
   leds[XY( i, j)] += CHSV( ms / 11, 200, 255);
   leds[XY( j, i)] += CHSV( ms / 13, 200, 255);
   leds[XY(ni, nj)] += CHSV( ms / 17, 200, 255);
@@ -607,7 +638,7 @@ void blurpattern()
 }
 
 const uint8_t kBorderWidth = 0;
-const uint8_t kSquareWidth = 16;
+const uint8_t kSquareWidth = min(kMatrixWidth, kMatrixHeight);
 
 void blurpattern2()
 {
@@ -622,7 +653,7 @@ void blurpattern2()
   // blur it repeatedly.  Since the blurring is 'lossy', there's
   // an automatic trend toward black -- by design.
   uint8_t blurAmount = dim8_raw( beatsin8(3, 64, 64) );
-  blur2d( leds, kMatrixWidth, kMatrixWidth, blurAmount);
+  blurAll(blurAmount);
 
   // Use three out-of-sync sine waves
   uint8_t  i = beatsin16(  91 / 2, kBorderWidth, kSquareWidth - kBorderWidth);
@@ -630,7 +661,7 @@ void blurpattern2()
   uint8_t  k = beatsin16(  73 / 2, kBorderWidth, kSquareWidth - kBorderWidth);
 
   // The color of each point shifts over time, each at a different speed.
-  uint16_t ms = millis();
+  uint16_t ms = currentMillis;
   leds[XY( i, j)] += CHSV( ms / 29, 200, 255);
   leds[XY( j, k)] += CHSV( ms / 41, 200, 255);
   leds[XY( k, i)] += CHSV( ms / 73, 200, 255);
@@ -647,14 +678,14 @@ void waves() {
 
   uint8_t blurAmount = dim8_raw( beatsin8(3, 64, 192) );      // A sinewave at 3 Hz with values ranging from 64 to 192.
   blur1d(leds, NUM_LEDS, blurAmount);                         // Apply some blurring to whatever's already on the strip, which will eventually go black.
-  //  blur2d(leds, 16, 16, blurAmount);
+  //  blur2d(leds, kMatrixWidth, kMatrixHeight, blurAmount);
 
-  uint8_t  i = beatsin16( 9, 0, NUM_LEDS);
-  uint8_t  j = beatsin16( 7, 0, NUM_LEDS);
-  uint8_t  k = beatsin16( 5, 0, NUM_LEDS);
+  uint16_t i = beatsin16( 9, 0, NUM_LEDS - 1);
+  uint16_t j = beatsin16( 7, 0, NUM_LEDS - 1);
+  uint16_t k = beatsin16( 5, 0, NUM_LEDS - 1);
 
   // The color of each point shifts over time, each at a different speed.
-  uint16_t ms = millis();
+  uint16_t ms = currentMillis;
   leds[deg((i + j) / 2)] = CHSV( ms / 29, 200, 255);
   leds[deg((j + k) / 2)] = CHSV( ms / 41, 200, 255);
   leds[deg((k + i) / 2)] = CHSV( ms / 73, 200, 255);
@@ -675,15 +706,15 @@ void waves2() {
   uint8_t blurAmount = dim8_raw( beatsin8(3, 64, 192) );      // A sinewave at 3 Hz with values ranging from 64 to 192.
   blurAmount = 10;
   //    blur1d(leds, NUM_LEDS, blurAmount);                         // Apply some blurring to whatever's already on the strip, which will eventually go black.
-  blur2d(leds, 16, 16, blurAmount);
+  blurAll(blurAmount);
   //  blurpattern();
 
-  uint8_t  i = beatsin16( 9, 0, NUM_LEDS);
-  uint8_t  j = beatsin16( 7, 0, NUM_LEDS);
-  uint8_t  k = beatsin16( 5, 0, NUM_LEDS);
+  uint16_t i = beatsin16( 9, 0, NUM_LEDS - 1);
+  uint16_t j = beatsin16( 7, 0, NUM_LEDS - 1);
+  uint16_t k = beatsin16( 5, 0, NUM_LEDS - 1);
 
   // The color of each point shifts over time, each at a different speed.
-  uint16_t ms = millis();
+  uint16_t ms = currentMillis;
   leds[deg((i + j) / 2)] = CHSV( ms / 29, 200, 255);
   leds[deg((j + k) / 2)] = CHSV( ms / 41, 200, 255);
   leds[deg((k + i) / 2)] = CHSV( ms / 73, 200, 255);
@@ -703,15 +734,15 @@ void waves3() {
   uint8_t blurAmount = dim8_raw( beatsin8(3, 64, 192) );      // A sinewave at 3 Hz with values ranging from 64 to 192.
   blurAmount = 10;
   ///    blur1d(leds, NUM_LEDS, blurAmount);                         // Apply some blurring to whatever's already on the strip, which will eventually go black.
-  blur2d(leds, 16, 16, blurAmount);
+  blurAll(blurAmount);
   //  blurpattern();
 
-  uint8_t  i = beatsin16( 9, 0, NUM_LEDS);
-  uint8_t  j = beatsin16( 7, 0, NUM_LEDS);
-  uint8_t  k = beatsin16( 5, 0, NUM_LEDS);
+  uint16_t i = beatsin16( 9, 0, NUM_LEDS - 1);
+  uint16_t j = beatsin16( 7, 0, NUM_LEDS - 1);
+  uint16_t k = beatsin16( 5, 0, NUM_LEDS - 1);
 
   // The color of each point shifts over time, each at a different speed.
-  uint16_t ms = millis();
+  uint16_t ms = currentMillis;
   leds[deg((i + j) / 2)] = CHSV( ms / 29, 200, 255);
   leds[deg((j + k) / 2)] = CHSV( ms / 41, 200, 255);
   leds[deg((k + i) / 2)] = CHSV( ms / 73, 200, 255);
@@ -722,7 +753,7 @@ void waves3() {
 void sinisterSpiral()
 {
   //Play with these values to customize the spiral
-  static byte pulseWaveTick = 0;
+  static uint16_t pulseWavePhase = 0; // 8.8 fixed point
   static byte vert = 1; //down (use -1 for up)
   static byte wavelength = 8;
   static byte frequencyMultiplier = 1;
@@ -736,13 +767,14 @@ void sinisterSpiral()
     fadingActive = false;
   }
 
-  uint16_t ms = millis();
+  uint16_t ms = currentMillis;
+  byte pulseWaveTick = pulseWavePhase >> 8;
 
   //Pixels up
-  for (byte x = 0; x < kMatrixHeight; x++)
+  for (byte x = 0; x < FIELD_WIDTH; x += FIELD_STEP)
   {
     //Pixels around beacon
-    for (byte y = 0; y < kMatrixWidth; y++)
+    for (byte y = 0; y < FIELD_HEIGHT; y += FIELD_STEP)
     {
       byte sinCalc = ((y * wavelength * rFreq) + (vert * pulseWaveTick) + (x * wavelength * hFreq)) * frequencyMultiplier;
       byte sinVal = sin8(sinCalc);
@@ -754,54 +786,570 @@ void sinisterSpiral()
       }
 
       //Up/Down Waves
-      leds[XY( x, y)] = CHSV( ms / 37 + (x * 5), 255, sinVal);
+      fieldPixel(x, y) = CHSV( ms / 37 + (x * 5), 255, sinVal);
 
       //Sweeper Waves
       //leds[XYsafe( x, y)] = CHSV( ms / 37 + (y * 5), 255, sinVal));
     }
   }
 
-  pulseWaveTick = pulseWaveTick + 8;
+  fieldUpscale();
+
+  pulseWavePhase += frameStep(8 * 256);
+}
+
+// Slowly churning noise textures, the field is kept by NoiseXY.h
+void lavaNoise() {
+
+  // startup tasks
+  if (effectInit == false) {
+    effectInit = true;
+    effectDelay = 20;
+    fadingActive = false;
+    currentPalette = LavaColors_p;
+    noiseInit(30, 6);
+  }
+
+  noiseUpdate();
+  noiseDraw();
 }
 
-void matrixConsole() {
-  EVERY_N_MILLIS(75) // falling speed
-  {
-    // move code downward
-    // start with lowest row to allow proper overlapping on each column
-    for (int8_t row = kMatrixHeight - 1; row >= 0; row--)
-    {
-      for (int8_t col = 0; col < kMatrixWidth; col++)
-      {
-        if (leds[deg(XY(col, row))] == CRGB(175, 255, 175))
-        {
-          leds[deg(XY(col, row))] = CRGB(27, 130, 39); // create trail
-          if (row < kMatrixHeight - 1) leds[deg(XY(col, row + 1))] = CRGB(175, 255, 175);
-        }
-      }
+void cloudNoise() {
+
+  // startup tasks
+  if (effectInit == false) {
+    effectInit = true;
+    effectDelay = 20;
+    fadingActive = false;
+    currentPalette = CloudColors_p;
+    noiseInit(20, 4);
+  }
+
+  noiseUpdate();
+  noiseDraw();
+}
+
+void oceanNoise() {
+
+  // startup tasks
+  if (effectInit == false) {
+    effectInit = true;
+    effectDelay = 20;
+    fadingActive = false;
+    currentPalette = OceanColors_p;
+    noiseInit(40, 10);
+  }
+
+  noiseUpdate();
+  noiseDraw();
+}
+
+// Fire2012 by Mark Kriegsman, one flame per column rising from the bottom edge
+// Heat is one byte per pixel, kept in effectScratch
+#define FIRE_COOLING 55  // more cooling == shorter flames
+#define FIRE_SPARKING 120 // chance of a new spark per column, 0-255
+void fire2D() {
+
+  byte *heat = effectScratch;
+  static uint16_t fireCarry = 0;
+
+  // startup tasks
+  if (effectInit == false) {
+    effectInit = true;
+    effectDelay = 30;
+    fadingActive = false;
+    currentPalette = HeatColors_p;
+    memset(heat, 0, NUM_LEDS);
+    fireCarry = 0;
+  }
+
+  // the simulation moves one step per design frame, the colors are mapped once
+  for (byte steps = frameSteps(fireCarry); steps > 0; steps--) {
+
+    // cool every cell down a little
+    byte maxCooling = ((FIRE_COOLING * 10) / kMatrixHeight) + 2;
+    for (uint16_t i = 0; i < NUM_LEDS; i++) {
+      heat[i] = qsub8(heat[i], random8(maxCooling));
     }
 
-    // fade all leds
-    for (int i = 0; i < NUM_LEDS; i++) {
-      if (leds[i].g != 255) leds[i].nscale8(192); // only fade trail
+    // heat drifts up and diffuses, working down from the top row so each row
+    // is built from the two rows below it before they are updated
+    for (byte y = 0; y < kMatrixHeight - 2; y++) {
+      byte *row = &heat[y * kMatrixWidth];
+      const byte *below = row + kMatrixWidth;
+      const byte *below2 = below + kMatrixWidth;
+      for (byte x = 0; x < kMatrixWidth; x++) {
+        row[x] = ((uint16_t)(below[x] + below2[x] + below2[x]) * 85) >> 8; // divide by 3
+      }
     }
 
-    // check for empty screen to ensure code spawn
-    bool emptyScreen = true;
-    for (int i = 0; i < NUM_LEDS; i++) {
-      if (leds[i])
-      {
-        emptyScreen = false;
-        break;
+    // randomly ignite new sparks near the bottom
+    for (byte x = 0; x < kMatrixWidth; x++) {
+      if (random8() < FIRE_SPARKING) {
+        byte y = kMatrixHeight - 1 - random8(2);
+        heat[y * kMatrixWidth + x] = qadd8(heat[y * kMatrixWidth + x], random8(160, 255));
       }
     }
+  }
 
-    // spawn new falling code
-    if (random8(3) == 0 || emptyScreen) // lower number == more frequent spawns
-    {
-      int8_t spawnX = random8(kMatrixWidth);
-      leds[deg(XY(spawnX, 0))] = CRGB(175, 255, 175 );
+  // map heat to colors
+  for (byte y = 0; y < kMatrixHeight; y++) {
+    const byte *row = &heat[y * kMatrixWidth];
+    for (byte x = 0; x < kMatrixWidth; x++) {
+      leds[XY(x, y)] = ColorFromPalette(currentPalette, scale8(row[x], 240), 255);
+    }
+  }
+}
+
+// Game of Life, the board is kept by LifeXY.h
+// Dead cells fade out through the global fade, the board reseeds when it settles
+void lifeGame(boolean wrap) {
+
+  static uint16_t lifeCarry = 0;
+
+  // startup tasks
+  if (effectInit == false) {
+    effectInit = true;
+    effectDelay = 100;
+    fadingActive = true;
+    fadeBaseColor = CRGB::Black;
+    lifeSeed();
+    lifeCarry = 0;
+  }
+
+  // one generation per design frame
+  for (byte steps = frameSteps(lifeCarry); steps > 0; steps--) {
+    lifeStep(wrap);
+    if (lifeStagnant()) lifeSeed();
+  }
+  lifeDraw(CHSV(cycleHue, 200, 255));
+}
+
+// Edges are dead cells
+void lifeBounded() {
+  lifeGame(false);
+}
+
+// Opposite edges are joined
+void lifeWrap() {
+  lifeGame(true);
+}
+
+// Two beating hearts cross the array, blended where they overlap
+void hearts() {
+
+  static int16_t heartPos = 0;    // 8.8 fixed point
+  static uint16_t heartBeat = 0;  // 8.8 fixed point
+
+  // startup tasks
+  if (effectInit == false) {
+    effectInit = true;
+    effectDelay = 60;
+    fadingActive = false;
+    heartPos = -(int16_t)pgm_read_byte(&heart.width) * 256;
+  }
+
+  byte heartWidth = pgm_read_byte(&heart.width);
+  byte heartHeight = pgm_read_byte(&heart.height);
+  byte frame = (heartBeat >> 10) % pgm_read_byte(&heart.frameCount);
+  int16_t heartX = heartPos >> 8;
+
+  fadeAll(80);
+  blitSprite(&heart, frame, heartX, kMatrixHeight / 2 - heartHeight, SPRITE_ADD);
+  blitSprite(&heart, frame, kMatrixWidth - heartWidth - heartX, kMatrixHeight / 2, SPRITE_ADD);
+
+  heartBeat += frameStep(256);
+  heartPos += frameStep(256);
+  if ((heartPos >> 8) > kMatrixWidth) heartPos = -heartWidth * 256;
+}
+
+// A filled square spins inside an anti-aliased ring of lines, uses raster.h
+void spinningShapes() {
+
+  static uint16_t spinAngle = 0;
+
+  // startup tasks
+  if (effectInit == false) {
+    effectInit = true;
+    effectDelay = 20;
+    fadingActive = false;
+    selectRandomPalette();
+  }
+
+  fix88 cx = FIX88(kMatrixWidth - 1) / 2;
+  fix88 cy = FIX88(kMatrixHeight - 1) / 2;
+  int16_t radius = (min(kMatrixWidth, kMatrixHeight) - 2) * 128; // 8.8, half the short side
+
+  fix88 xs[4], ys[4];
+  for (byte i = 0; i < 4; i++) {
+    uint16_t angle = spinAngle + i * 16384;
+    xs[i] = cx + ((int32_t)cos16(angle) * radius >> 16);
+    ys[i] = cy + ((int32_t)sin16(angle) * radius >> 16);
+  }
+
+  fillAll(CRGB::Black);
+  fillPolygon(xs, ys, 4, ColorFromPalette(currentPalette, cycleHue, 255));
+
+  // the outer square turns the other way
+  for (byte i = 0; i < 4; i++) {
+    uint16_t angle = -spinAngle + i * 16384;
+    xs[i] = cx + ((int32_t)cos16(angle) * radius >> 15);
+    ys[i] = cy + ((int32_t)sin16(angle) * radius >> 15);
+  }
+  CRGB lineColor = ColorFromPalette(currentPalette, cycleHue + 128, 255);
+  for (byte i = 0; i < 4; i++) {
+    byte j = (i + 1) & 3;
+    drawLineAA(xs[i], ys[i], xs[j], ys[j], lineColor);
+  }
+
+  spinAngle += frameStep(400);
+}
+
+// Rotating wireframe solids, a different one every time, uses render3d.h
+void wireframeSolids() {
+
+  static byte solidNumber = 0;
+  static uint16_t solidSpin = 0; // 8.8 fixed point
+
+  // startup tasks
+  if (effectInit == false) {
+    effectInit = true;
+    effectDelay = 10;
+    fadingActive = false;
+    selectRandomPalette();
+    solidNumber = (solidNumber + 1) % SOLIDS_3D;
+  }
+
+  Solid3D solid;
+  solid3D(solidNumber, solid);
+  Matrix3D turn;
+  rotation3D(turn, solidSpin >> 8, solidSpin >> 7, (solidSpin >> 9) * 3);
+
+  fillAll(CRGB::Black);
+  drawSolid3D(solid, turn, FIX88(2.5), cycleHue);
+
+  solidSpin += frameStep(2 * 256);
+}
+
+// Flying through a field of stars, uses render3d.h
+// Stars keep no state: each one's depth follows from the distance travelled
+// and its number, and it gets a new place every time it passes the camera.
+#define STARFIELD_STARS 48
+#define STARFIELD_DEPTH FIX88(8) // a power of two
+#define STARFIELD_SPEED 24       // 8.8 units per frame
+#define STARFIELD_TRAIL 3        // frames of movement in each streak
+
+void starfield() {
+
+  static uint16_t starTravel = 0; // 8.8 units
+
+  // startup tasks
+  if (effectInit == false) {
+    effectInit = true;
+    effectDelay = 10;
+    fadingActive = false;
+  }
+
+  fillAll(CRGB::Black);
+
+  for (byte i = 0; i < STARFIELD_STARS; i++) {
+    uint16_t travel = starTravel + i * (STARFIELD_DEPTH / STARFIELD_STARS);
+    uint16_t pass = (travel / STARFIELD_DEPTH) * 31 + i; // changes when the star wraps around
+
+    // scatter the star over -4 to 4 units across and up
+    uint16_t h = (pass + 1) * 0x9E37;
+    h ^= h >> 7;
+    h *= 0x2F6B;
+    h ^= h >> 8;
+
+    Point3D head = {(fix88)((int8_t)h * 8), (fix88)((int8_t)(h >> 8) * 8), (fix88)(STARFIELD_DEPTH - (travel & (STARFIELD_DEPTH - 1)))};
+    Point3D tail = head;
+    tail.z += STARFIELD_SPEED * STARFIELD_TRAIL;
+
+    fix88 hx, hy, tx, ty;
+    if (!render3DProject(head, hx, hy)) continue;
+    if (!render3DProject(tail, tx, ty)) {
+      tx = hx;
+      ty = hy;
+    }
+    byte level = 255 - (uint16_t)(head.z - 1) / (STARFIELD_DEPTH / 256); // a shift, no division per star
+    drawLineAA(tx, ty, hx, hy, CRGB(level, level, level));
+  }
+
+  starTravel += frameStep(STARFIELD_SPEED);
+}
+
+// Flying down a winding tunnel of rings, uses render3d.h
+#define TUNNEL_RINGS 5
+#define TUNNEL_SIDES 8
+#define TUNNEL_BEND 20 // how fast the tunnel winds, angle per ring
+
+// Offset of the tunnel centre at a distance along it, 8.8 rings
+void tunnelCentre(uint16_t along, fix88 &x, fix88 &y) {
+  byte angle = (uint32_t)along * TUNNEL_BEND >> 8;
+  x = sin3D(angle) / 2;
+  y = sin3D(angle * 2 + 64) / 4;
+}
+
+void tunnelFlight() {
+
+  static uint16_t tunnelTravel = 0; // 8.8 rings
+  static uint16_t tunnelSpin = 0; // 8.8 fixed point
+
+  // startup tasks
+  if (effectInit == false) {
+    effectInit = true;
+    effectDelay = 10;
+    fadingActive = false;
+    selectRandomPalette();
+  }
+
+  // the camera follows the centre line
+  fix88 cameraX, cameraY;
+  tunnelCentre(tunnelTravel, cameraX, cameraY);
+
+  fix88 xs[TUNNEL_SIDES], ys[TUNNEL_SIDES];
+  fix88 lastXs[TUNNEL_SIDES], lastYs[TUNNEL_SIDES];
+  byte lastShown = 0;
+
+  fillAll(CRGB::Black);
+
+  // far rings first, nearer ones are drawn over them
+  for (byte k = TUNNEL_RINGS; k > 0; k--) {
+    uint16_t ring = (tunnelTravel >> 8) + k;
+    fix88 z = FIX88(k) - (tunnelTravel & 0xFF);
+    fix88 centreX, centreY;
+    tunnelCentre(ring << 8, centreX, centreY);
+    CRGB color = ColorFromPalette(currentPalette, ring * 16, render3DFade(z, FIX88(1), FIX88(TUNNEL_RINGS)));
+
+    byte shown = 0;
+    for (byte s = 0; s < TUNNEL_SIDES; s++) {
+      byte angle = s * (256 / TUNNEL_SIDES) + (tunnelSpin >> 8);
+      Point3D p = {(fix88)(centreX - cameraX + cos3D(angle)), (fix88)(centreY - cameraY + sin3D(angle)), z};
+      if (render3DProject(p, xs[s], ys[s])) shown |= 1 << s;
+    }
+
+    for (byte s = 0; s < TUNNEL_SIDES; s++) {
+      byte next = (s + 1) % TUNNEL_SIDES;
+      if ((shown & (1 << s)) && (shown & (1 << next))) drawLineAA(xs[s], ys[s], xs[next], ys[next], color);
+      // every other side runs back to the ring behind
+      if ((s & 1) && (shown & lastShown & (1 << s))) drawLineAA(xs[s], ys[s], lastXs[s], lastYs[s], color);
+    }
+
+    memcpy(lastXs, xs, sizeof(xs));
+    memcpy(lastYs, ys, sizeof(ys));
+    lastShown = shown;
+  }
+
+  tunnelTravel += frameStep(20);
+  tunnelSpin += frameStep(256);
+}
+
+// Rings spreading out from the centre, uses polarmap.h
+void radialRipples() {
+
+  static uint16_t ripplePhase = 0; // 8.8 fixed point
+
+  // startup tasks
+  if (effectInit == false) {
+    effectInit = true;
+    effectDelay = 20;
+    fadingActive = false;
+    selectRandomPalette();
+  }
+
+  byte t = ripplePhase >> 8;
+  for (byte y = 0; y < kMatrixHeight; y++) {
+    for (byte x = 0; x < kMatrixWidth; x++) {
+      byte radius = polarRadius(x, y);
+      leds[XY(x, y)] = ColorFromPalette(currentPalette, cycleHue + (radius >> 1), sin8(radius * 4 - t * 4));
+    }
+  }
+
+  ripplePhase += frameStep(256);
+}
+
+// Three arms turning around the centre, uses polarmap.h
+void spiralArms() {
+
+  static uint16_t spiralPhase = 0; // 8.8 fixed point
+
+  // startup tasks
+  if (effectInit == false) {
+    effectInit = true;
+    effectDelay = 20;
+    fadingActive = false;
+    selectRandomPalette();
+  }
+
+  byte t = spiralPhase >> 8;
+  for (byte y = 0; y < kMatrixHeight; y++) {
+    for (byte x = 0; x < kMatrixWidth; x++) {
+      byte angle = polarAngle(x, y);
+      byte radius = polarRadius(x, y);
+      leds[XY(x, y)] = ColorFromPalette(currentPalette, angle + t, sin8(angle * 3 + radius * 2 - t * 3));
+    }
+  }
+
+  spiralPhase += frameStep(256);
+}
+
+// Flying down a striped tunnel, uses polarmap.h
+void polarTunnel() {
+
+  static uint16_t tunnelPhase = 0; // 8.8 fixed point
+
+  // startup tasks
+  if (effectInit == false) {
+    effectInit = true;
+    effectDelay = 20;
+    fadingActive = false;
+    selectRandomPalette();
+  }
+
+  byte t = tunnelPhase >> 8;
+  for (byte y = 0; y < kMatrixHeight; y++) {
+    for (byte x = 0; x < kMatrixWidth; x++) {
+      byte angle = polarAngle(x, y);
+      byte depth = polarDepth(polarRadius(x, y));
+      byte wall = (sin8(depth * 4 + t * 4) >> 1) + (sin8(angle * 4 + t) >> 1);
+      leds[XY(x, y)] = ColorFromPalette(currentPalette, depth + t, scale8(wall, 255 - depth)); // far end is dark
+    }
+  }
+
+  tunnelPhase += frameStep(256);
+}
+
+// Colour bands that wind up and unwind around the centre, uses polarmap.h
+void polarSwirl() {
+
+  static uint16_t swirlPhase = 0; // 8.8 fixed point
+
+  // startup tasks
+  if (effectInit == false) {
+    effectInit = true;
+    effectDelay = 20;
+    fadingActive = false;
+    selectRandomPalette();
+  }
+
+  byte t = swirlPhase >> 8;
+  int8_t twist = sin8(t) - 128; // how far the outside is turned against the centre
+  for (byte y = 0; y < kMatrixHeight; y++) {
+    for (byte x = 0; x < kMatrixWidth; x++) {
+      byte angle = polarAngle(x, y);
+      byte radius = polarRadius(x, y);
+      byte swirled = angle + ((radius * twist) >> 6);
+      leds[XY(x, y)] = ColorFromPalette(currentPalette, swirled * 2 + t, qadd8(sin8(swirled * 4), 32));
+    }
+  }
+
+  swirlPhase += frameStep(256);
+}
+
+#ifdef OVERLAY_LAYERS
+// Christmas message scrolling over the rotating plasma, uses layers.h
+void plasmaMessage() {
+  if (effectInit == false) {
+    startTextLayer(0, 0, LAYER_KEY, CRGBPalette16(CRGB::White));
+  }
+  spinPlasma();
+}
+
+// Fireworks bursting over falling snow, uses layers.h
+void snowFireworks() {
+  if (effectInit == false) {
+    startSparkLayer(0, LAYER_SCREEN, RainbowColors_p);
+  }
+  snow();
+}
+#endif
+
+// Falling green code, drops are tracked per column by RainXY.h
+void matrixConsole() {
+
+  // startup tasks
+  if (effectInit == false) {
+    effectInit = true;
+    effectDelay = 25;
+    fadingActive = false;
+    clearRain();
+    fillAll(CRGB::Black);
+  }
+
+  // only the pixels under the drops change, the rest of the canvas stays black
+  for (byte col = 0; col < RAIN_COLUMNS; col++) {
+    for (byte d = 0; d < DROPS_PER_COLUMN; d++) gDrops[col][d].Erase(col);
+    for (byte d = 0; d < DROPS_PER_COLUMN; d++) {
+      gDrops[col][d].Move();
+      gDrops[col][d].Draw(col);
+    }
+  }
+
+  // spawn new falling code, always keep at least one drop on screen
+  if (random8() < rainDensity || rainActiveDrops == 0) {
+    spawnRain(random8(RAIN_COLUMNS));
+  }
+}
+
+
+#ifdef AUDIO_REACTIVE
+
+// Frequency bands as bars rising from the bottom edge, needs audio.h
+void spectrumBars() {
+
+  // startup tasks
+  if (effectInit == false) {
+    effectInit = true;
+    effectDelay = 20;
+    selectRandomPalette();
+    fadingActive = false;
+  }
+
+  for (byte x = 0; x < kMatrixWidth; x++) {
+    byte band = x * NUM_BANDS / kMatrixWidth;
+    byte barHeight = scale8(audioBands[band], kMatrixHeight);
+    CRGB barColor = ColorFromPalette(currentPalette, cycleHue + band * (256 / NUM_BANDS), 255);
+    for (byte y = 0; y < kMatrixHeight; y++) {
+      leds[XY(x, y)] = (y >= kMatrixHeight - barHeight) ? barColor : CRGB::Black;
+    }
+  }
+}
+
+// Square rings burst out from the centre on every beat, needs audio.h
+void beatPulse() {
+
+  static byte pulseRadius = 255;
+  static byte pulseHue = 0;
+
+  // startup tasks
+  if (effectInit == false) {
+    effectInit = true;
+    effectDelay = 15;
+    fadingActive = false;
+    pulseRadius = 255;
+  }
+
+  if (audioBeat) {
+    hueCycle(32); // every beat moves the global hue along
+    pulseHue = cycleHue;
+    pulseRadius = 0;
+  }
+
+  fadeAll(40);
+
+  if (pulseRadius < kMatrixWidth / 2) {
+    CRGB pulseColor = CHSV(pulseHue, 255, qadd8(audioLevel, 128));
+    byte cx = kMatrixWidth / 2;
+    byte cy = kMatrixHeight / 2;
+    for (int8_t d = -pulseRadius; d <= pulseRadius; d++) {
+      leds[XY(cx + d, cy - pulseRadius)] = pulseColor;
+      leds[XY(cx + d, cy + pulseRadius)] = pulseColor;
+      leds[XY(cx - pulseRadius, cy + d)] = pulseColor;
+      leds[XY(cx + pulseRadius, cy + d)] = pulseColor;
     }
+    pulseRadius++;
   }
 }
 
+#endif
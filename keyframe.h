@@ -0,0 +1,77 @@
+// Keyframe interpolation for expensive effects
+// With KEYFRAME_FRAMES above 1, an effect that opts in only renders every
+// Nth call. The calls in between move the shown frame a step closer to the
+// newest keyframe, so the output is a linear blend from one keyframe to the
+// next, running one keyframe behind the render.
+//
+// An effect opts in by calling keyframeReset() in its startup tasks and
+//   if (keyframeInBetween()) return;
+// before it draws, then keyframeCapture() once the frame is in leds[].
+// Counters should advance by frameStep(), frameTicks covers the skipped calls.
+//
+// Costs NUM_LEDS * 3 bytes of RAM, too much for the 2K AVR boards.
+
+#if KEYFRAME_FRAMES > 1
+
+CRGB keyframeNext[NUM_LEDS];
+byte keyframeRemaining = 0; // blend steps left before the next render
+uint16_t keyframeTicks = 0; // frame time skipped since the last render, 8.8
+boolean keyframeValid = false;
+
+void keyframeReset() {
+  keyframeRemaining = 0;
+  keyframeTicks = 0;
+  keyframeValid = false;
+}
+
+// Move the shown frame 1/steps of the way to the next keyframe
+void keyframeStep(byte steps) {
+  if (steps <= 1) {
+    memcpy(leds, keyframeNext, sizeof(keyframeNext));
+    return;
+  }
+  byte amount = 256 / steps;
+  for (uint16_t i = 0; i < NUM_LEDS; i++) nblend(leds[i], keyframeNext[i], amount);
+}
+
+// True when this call was an in-between frame and leds[] is already updated
+boolean keyframeInBetween() {
+  if (keyframeRemaining == 0) {
+    // render now, catching up on the time the in-between frames skipped
+    frameTicks += keyframeTicks;
+    keyframeTicks = 0;
+    return false;
+  }
+
+  keyframeTicks += frameTicks;
+  keyframeStep(keyframeRemaining--);
+  return true;
+}
+
+// Store the frame just rendered in leds[] as the next keyframe
+void keyframeCapture() {
+  if (keyframeValid) {
+    // leds[] held the previous keyframe before the render; swap so the
+    // render becomes the blend target and the old frame is shown
+    for (uint16_t i = 0; i < NUM_LEDS; i++) {
+      CRGB rendered = leds[i];
+      leds[i] = keyframeNext[i];
+      keyframeNext[i] = rendered;
+    }
+    keyframeStep(KEYFRAME_FRAMES);
+  } else {
+    memcpy(keyframeNext, leds, sizeof(keyframeNext));
+    keyframeValid = true;
+  }
+  keyframeRemaining = KEYFRAME_FRAMES - 1;
+}
+
+#else
+
+void keyframeReset() {}
+boolean keyframeInBetween() {
+  return false;
+}
+void keyframeCapture() {}
+
+#endif
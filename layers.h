@@ -0,0 +1,267 @@
+// Overlay layers drawn on top of the running effect
+// Each layer is a mask of 4-bit levels, two pixels to a byte, 0 being
+// transparent, drawn in one entry of the layer's palette. A layer has its own
+// render function and delay, and is only redrawn when that delay has passed.
+//
+// Every time the effect draws a frame the visible layers are blended into it
+// pixel by pixel in a single pass over the rows they cover. Nothing is saved
+// or put back: the overlay stays in leds[] until the effect's next frame
+// draws over it, so layers are for effects that redraw every pixel each frame.
+// A layer marks itself dirty when it redraws, and only dirty layers have the
+// rows they cover worked out again; empty layers and the rows outside a
+// layer's bounds are skipped.
+//
+// RAM use is NUM_LEDS / 2 bytes per layer plus the layer's palette and state,
+// about 190 bytes for one layer on a 16x16 canvas. memstats.h checks it fits.
+//
+// An effect starts its layers with layerStart() in its startup tasks; they
+// stop by themselves when a different effect is selected.
+//
+// Needs OVERLAY_LAYERS defined.
+
+#ifdef OVERLAY_LAYERS
+
+#define LAYER_COUNT 1
+#define LAYER_TEXT_ROWS 5 // rows a line of text covers
+#define LAYER_MASK_BYTES ((NUM_LEDS + 1) / 2)
+
+#define LAYER_NORMAL 0 // cover the effect in proportion to the level
+#define LAYER_ADD    1 // add light to the effect
+#define LAYER_SCREEN 2 // lighten the effect, softer than add near white
+#define LAYER_KEY    3 // replace the effect wherever the level is not zero
+
+typedef void (*layerFunction)(byte layer);
+
+struct Layer {
+  layerFunction render; // NULL while the layer is not in use
+  byte mode;
+  byte owner;           // effect that started the layer
+  byte slot;            // palette entry the layer is drawn in
+  boolean dirty;        // redrawn since its bounds were worked out
+  uint16_t delay;
+  unsigned long millis;
+  byte firstRow;        // rows with visible pixels, firstRow > lastRow when empty
+  byte lastRow;
+  CRGBPalette16 palette;
+};
+
+Layer layers[LAYER_COUNT];
+byte layerMasks[LAYER_COUNT][LAYER_MASK_BYTES]; // canvas order, y * kMatrixWidth + x, even pixels in the low nibble
+
+inline byte layerGet(byte layer, uint16_t i) {
+  byte pair = layerMasks[layer][i >> 1];
+  return (i & 1) ? pair >> 4 : pair & 0x0F;
+}
+
+inline void layerPut(byte layer, uint16_t i, byte level) {
+  byte &pair = layerMasks[layer][i >> 1];
+  pair = (i & 1) ? (pair & 0x0F) | (level << 4) : (pair & 0xF0) | level;
+}
+
+void layerSet(byte layer, int16_t x, int16_t y, byte level) {
+  if (x >= 0 && x < kMatrixWidth && y >= 0 && y < kMatrixHeight) layerPut(layer, y * kMatrixWidth + x, level);
+}
+
+// Find the rows that hold anything, run for dirty layers before blending
+void layerBounds(byte layer) {
+  layers[layer].firstRow = kMatrixHeight;
+  layers[layer].lastRow = 0;
+  for (byte y = 0; y < kMatrixHeight; y++) {
+    uint16_t i = y * kMatrixWidth;
+    for (byte x = 0; x < kMatrixWidth; x++, i++) {
+      if (layerGet(layer, i)) {
+        if (layers[layer].firstRow == kMatrixHeight) layers[layer].firstRow = y;
+        layers[layer].lastRow = y;
+        break;
+      }
+    }
+  }
+  layers[layer].dirty = false;
+}
+
+void layerStart(byte layer, layerFunction render, byte mode, uint16_t delay, const CRGBPalette16 &palette) {
+  memset(layerMasks[layer], 0, LAYER_MASK_BYTES);
+  layers[layer].render = render;
+  layers[layer].mode = mode;
+  layers[layer].owner = currentEffect;
+  layers[layer].slot = 0;
+  layers[layer].delay = delay;
+  layers[layer].millis = currentMillis;
+  layers[layer].palette = palette;
+  render(layer);
+  layers[layer].dirty = true;
+}
+
+// Redraw the layers that are due, called with each effect frame
+void layersUpdate() {
+  for (byte l = 0; l < LAYER_COUNT; l++) {
+    Layer &layer = layers[l];
+    if (layer.render == NULL) continue;
+
+    if (layer.owner != currentEffect) {
+      layer.render = NULL;
+      continue;
+    }
+
+    if (currentMillis - layer.millis > layer.delay) {
+      layer.millis = currentMillis;
+      layer.render(l);
+      layer.dirty = true;
+    }
+  }
+}
+
+// Blend every visible layer into the frame the effect just drew
+void layersComposite() {
+  byte firstRow = kMatrixHeight;
+  byte lastRow = 0;
+  for (byte l = 0; l < LAYER_COUNT; l++) {
+    if (layers[l].render == NULL) continue;
+    if (layers[l].dirty) layerBounds(l);
+    if (layers[l].firstRow > layers[l].lastRow) continue;
+    if (layers[l].firstRow < firstRow) firstRow = layers[l].firstRow;
+    if (layers[l].lastRow > lastRow) lastRow = layers[l].lastRow;
+  }
+
+  for (byte y = firstRow; y <= lastRow && y < kMatrixHeight; y++) {
+    for (byte x = 0; x < kMatrixWidth; x++) {
+      uint16_t i = y * kMatrixWidth + x;
+      CRGB *pixel = NULL;
+
+      for (byte l = 0; l < LAYER_COUNT; l++) {
+        if (layers[l].render == NULL || y < layers[l].firstRow || y > layers[l].lastRow) continue;
+        byte level = layerGet(l, i);
+        if (level == 0) continue;
+
+        if (pixel == NULL) pixel = &leds[XY(x, y)];
+        CRGB color = layers[l].palette[layers[l].slot];
+        byte alpha = level * 17; // 15 becomes 255
+        switch (layers[l].mode) {
+          case LAYER_NORMAL:
+            nblend(*pixel, color, alpha);
+            break;
+
+          case LAYER_ADD:
+            *pixel += color.nscale8(alpha);
+            break;
+
+          case LAYER_SCREEN:
+            color.nscale8(alpha);
+            pixel->r = 255 - scale8(255 - pixel->r, 255 - color.r);
+            pixel->g = 255 - scale8(255 - pixel->g, 255 - color.g);
+            pixel->b = 255 - scale8(255 - pixel->b, 255 - color.b);
+            break;
+
+          case LAYER_KEY:
+            *pixel = color;
+            break;
+        }
+      }
+    }
+  }
+}
+
+
+// Layer renderers
+
+// Scrolls a stringArray message right to left through the middle rows,
+// stepping to the next palette entry with each character
+#define LAYER_CHAR_SPACING 2
+
+const char *layerMessage;
+byte layerMessageChar = 0;
+byte layerCharColumn = 0;
+byte layerColumns[5];
+
+void layerLoadChar() {
+  loadCharBuffer(pgm_read_byte(layerMessage + layerMessageChar));
+  memcpy(layerColumns, charBuffer, sizeof(layerColumns));
+}
+
+void textLayer(byte layer) {
+  // move everything one column to the left
+  for (byte y = 0; y < kMatrixHeight; y++) {
+    uint16_t i = y * kMatrixWidth;
+    for (byte x = 1; x < kMatrixWidth; x++, i++) layerPut(layer, i, layerGet(layer, i + 1));
+    layerPut(layer, i, 0);
+  }
+
+  if (layerCharColumn < 5) {
+    byte top = (kMatrixHeight - LAYER_TEXT_ROWS) / 2; // characters are 5 pixels tall
+    for (byte y = 0; y < LAYER_TEXT_ROWS; y++) {
+      if (bitRead(layerColumns[layerCharColumn], y)) layerSet(layer, kMatrixWidth - 1, top + y, 15);
+    }
+  }
+
+  if (++layerCharColumn > (4 + LAYER_CHAR_SPACING)) {
+    layerCharColumn = 0;
+    layerMessageChar++;
+    if (pgm_read_byte(layerMessage + layerMessageChar) == 0) layerMessageChar = 0; // null character at end of string
+    layers[layer].slot = layerMessageChar & 0x0F;
+    layerLoadChar();
+  }
+}
+
+void startTextLayer(byte layer, byte message, byte mode, const CRGBPalette16 &palette) {
+  layerMessage = (const char *)pgm_read_ptr(&stringArray[message]);
+  layerMessageChar = 0;
+  layerCharColumn = 0;
+  layerLoadChar();
+  layerStart(layer, textLayer, mode, 35, palette);
+}
+
+// Bursts of falling sparks that fade out inside the layer
+#define LAYER_SPARKS 12
+#define SPARK_GONE INT16_MAX
+
+int16_t sparkX[LAYER_SPARKS], sparkY[LAYER_SPARKS];  // 8.8 fixed point
+int8_t sparkDX[LAYER_SPARKS], sparkDY[LAYER_SPARKS]; // 1/32 pixel per frame
+byte sparksLeft = 0;
+
+void sparkLayer(byte layer) {
+  // fade the whole layer by one level, both pixels of a byte at once
+  for (uint16_t i = 0; i < LAYER_MASK_BYTES; i++) {
+    byte pair = layerMasks[layer][i];
+    if (pair & 0x0F) pair--;
+    if (pair & 0xF0) pair -= 0x10;
+    layerMasks[layer][i] = pair;
+  }
+
+  // start a new burst once the last one has fallen away
+  if (sparksLeft == 0) {
+    int16_t x = random8(2, kMatrixWidth - 2) << 8;
+    int16_t y = random8(2, kMatrixHeight / 2 + 1) << 8;
+    layers[layer].slot = random8(16);
+    for (byte s = 0; s < LAYER_SPARKS; s++) {
+      sparkX[s] = x;
+      sparkY[s] = y;
+      uint16_t angle = s * (65536 / LAYER_SPARKS) + random8();
+      sparkDX[s] = cos16(angle) >> 10;
+      sparkDY[s] = sin16(angle) >> 10;
+    }
+    sparksLeft = LAYER_SPARKS;
+  }
+
+  for (byte s = 0; s < LAYER_SPARKS; s++) {
+    if (sparkY[s] == SPARK_GONE) continue;
+    sparkX[s] += sparkDX[s] * 8;
+    sparkY[s] += sparkDY[s] * 8;
+    if (sparkDY[s] < 100) sparkDY[s] += 2; // gravity
+
+    int16_t x = sparkX[s] >> 8;
+    int16_t y = sparkY[s] >> 8;
+    if (x < 0 || x >= kMatrixWidth || y >= kMatrixHeight) {
+      sparkY[s] = SPARK_GONE;
+      sparksLeft--;
+      continue;
+    }
+    layerSet(layer, x, y, 15);
+  }
+}
+
+void startSparkLayer(byte layer, byte mode, const CRGBPalette16 &palette) {
+  sparksLeft = 0;
+  layerStart(layer, sparkLayer, mode, 30, palette);
+}
+
+#endif
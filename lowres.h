@@ -0,0 +1,62 @@
+// Half resolution rendering for smooth field effects
+// With HALF_RES_FIELDS defined, effects that draw through fieldPixel() only
+// evaluate every second column and row, into a small grid in effectScratch,
+// and fieldUpscale() fills leds[] from it by bilinear interpolation. That is
+// about a quarter of the per-pixel work. The grid reaches one pixel past the
+// right and bottom edges so every canvas pixel has neighbours on both sides.
+//
+// An effect opts in by drawing with
+//   for (x = 0; x < FIELD_WIDTH; x += FIELD_STEP)
+//     for (y = 0; y < FIELD_HEIGHT; y += FIELD_STEP)
+//       fieldPixel(x, y) = ...;
+// and calling fieldUpscale() afterwards. Without HALF_RES_FIELDS this is the
+// usual full resolution loop into leds[].
+
+#ifdef HALF_RES_FIELDS
+
+#define LOWRES_WIDTH (kMatrixWidth / 2 + 1)
+#define LOWRES_HEIGHT (kMatrixHeight / 2 + 1)
+
+static_assert(LOWRES_WIDTH * LOWRES_HEIGHT * sizeof(CRGB) <= SCRATCH_SIZE, "half resolution grid does not fit in effectScratch");
+
+#define lowRes ((CRGB *)effectScratch)
+
+#define FIELD_STEP 2
+#define FIELD_WIDTH (kMatrixWidth + 1)
+#define FIELD_HEIGHT (kMatrixHeight + 1)
+#define fieldPixel(x, y) lowRes[((y) >> 1) * LOWRES_WIDTH + ((x) >> 1)]
+
+// Canvas pixels fall on grid points or exactly halfway between them,
+// so the bilinear weights are only ever 1, 1/2 or 1/4
+void fieldUpscale() {
+  for (byte y = 0; y < kMatrixHeight; y++) {
+    const CRGB *top = &lowRes[(y >> 1) * LOWRES_WIDTH];
+    const CRGB *bottom = (y & 1) ? top + LOWRES_WIDTH : top;
+
+    for (byte x = 0; x < kMatrixWidth; x++) {
+      byte i = x >> 1;
+      CRGB pixel;
+      if (x & 1) {
+        pixel.r = (top[i].r + top[i + 1].r + bottom[i].r + bottom[i + 1].r + 2) >> 2;
+        pixel.g = (top[i].g + top[i + 1].g + bottom[i].g + bottom[i + 1].g + 2) >> 2;
+        pixel.b = (top[i].b + top[i + 1].b + bottom[i].b + bottom[i + 1].b + 2) >> 2;
+      } else {
+        pixel.r = (top[i].r + bottom[i].r + 1) >> 1;
+        pixel.g = (top[i].g + bottom[i].g + 1) >> 1;
+        pixel.b = (top[i].b + bottom[i].b + 1) >> 1;
+      }
+      leds[XY(x, y)] = pixel;
+    }
+  }
+}
+
+#else
+
+#define FIELD_STEP 1
+#define FIELD_WIDTH kMatrixWidth
+#define FIELD_HEIGHT kMatrixHeight
+#define fieldPixel(x, y) leds[XY(x, y)]
+
+void fieldUpscale() {}
+
+#endif
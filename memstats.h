@@ -0,0 +1,107 @@
+// RAM accounting
+// At reset, before main() runs, all RAM above the globals is filled with
+// STACK_CANARY. The stack wipes the pattern out as it grows down, so the
+// painted bytes still left show how close it has come to the globals.
+// With MEMORY_REPORT defined the remaining headroom is printed over serial
+// every MEMORY_REPORT_MILLIS. tools/ramreport.py breaks the static RAM use
+// down by module and effect from the compiled ELF file.
+//
+// The static_assert below adds up the large buffers for the current
+// configuration and stops the build if they cannot fit beside the stack.
+
+#define STACK_CANARY 0xC5
+#define MEMORY_REPORT_MILLIS 5000
+#define RAM_RESERVE 320 // stack, FastLED and the small globals not counted below
+
+// The large buffers, in bytes
+constexpr uint32_t ramBuffers =
+  sizeof(leds) + sizeof(effectScratch) + sizeof(currentPalette) +
+  sizeof(gSparks) + sizeof(lifeRows) + sizeof(noiseCoarse)
+#ifdef OVERLAY_LAYERS
+  + sizeof(layers) + sizeof(layerMasks)
+#endif
+#if KEYFRAME_FRAMES > 1
+  + sizeof(keyframeNext)
+#endif
+#ifdef AUDIO_REACTIVE
+  + sizeof(audioRing) + sizeof(fftReal) + sizeof(fftImag)
+#endif
+#ifdef DUAL_CORE_PIPELINE
+  + sizeof(outputBuffers)
+#endif
+#ifdef DEEP_COLOR
+  + sizeof(deepLeds) + sizeof(deepError)
+#endif
+#ifdef USER_PROGRAMS
+  + sizeof(vmStaged)
+#endif
+  ;
+
+#ifdef __AVR__
+#define RAM_SIZE (RAMEND + 1 - RAMSTART)
+static_assert(ramBuffers + RAM_RESERVE <= RAM_SIZE, "configuration does not fit in RAM, shrink the canvas or turn off layers, keyframes, audio or deep color");
+
+extern uint8_t _end;    // end of the globals
+extern uint8_t __stack; // top of RAM, where the stack starts
+
+// Runs from .init1, before the stack or r1 are set up, so it is all assembly
+void stackPaint() __attribute__((naked, used, section(".init1")));
+void stackPaint() {
+  __asm volatile (
+    "    ldi r30, lo8(_end)\n"
+    "    ldi r31, hi8(_end)\n"
+    "    ldi r24, %0\n"
+    "    ldi r25, hi8(__stack)\n"
+    "    rjmp 2f\n"
+    "1:  st Z+, r24\n"
+    "2:  cpi r30, lo8(__stack)\n"
+    "    cpc r31, r25\n"
+    "    brlo 1b\n"
+    "    breq 1b\n"
+    :: "i" (STACK_CANARY));
+}
+
+// Painted bytes the stack has never reached
+uint16_t stackHeadroom() {
+  const uint8_t *p = &_end;
+  uint16_t count = 0;
+  while (p <= &__stack && *p == STACK_CANARY) {
+    p++;
+    count++;
+  }
+  return count;
+}
+
+#elif defined(ESP32)
+uint16_t stackHeadroom() {
+  return uxTaskGetStackHighWaterMark(NULL); // main task, tracked by FreeRTOS
+}
+
+#else
+uint16_t stackHeadroom() {
+  return 0; // not measured on this board
+}
+#endif
+
+#ifdef MEMORY_REPORT
+unsigned long memoryMillis = 0;
+
+void memoryReport() {
+  Serial.print(F("RAM buffers "));
+  Serial.print(ramBuffers);
+#ifdef RAM_SIZE
+  Serial.print(F(" of "));
+  Serial.print(RAM_SIZE);
+#endif
+  Serial.println(F(" bytes"));
+}
+
+// Print the stack headroom now and then, call from loop()
+void memoryProbe() {
+  if (currentMillis - memoryMillis < MEMORY_REPORT_MILLIS) return;
+  memoryMillis = currentMillis;
+  Serial.print(F("stack headroom "));
+  Serial.print(stackHeadroom());
+  Serial.println(F(" bytes"));
+}
+#endif
@@ -0,0 +1,132 @@
+// LED output configuration
+// The canvas is split into NUM_STRIPS equal runs of consecutive LEDs, one run
+// per data pin. Number the panels in XYmap.h's tileMap along the data lines so
+// each strip drives a whole number of panels.
+//
+// Strips on separate pins are pushed one after another on AVR (and any other
+// board without PARALLEL_OUTPUT), so there splitting the canvas shortens the
+// wires but not the push: outputPushMicros() is NUM_STRIPS times a strip's.
+// ESP32 (RMT) and boards with a FastLED parallel port driver (PARALLEL_OUTPUT)
+// push them at the same time, so frame push time is set by the longest strip.
+
+#define STRIP_LEDS (NUM_LEDS / NUM_STRIPS)
+
+static_assert(NUM_LEDS % NUM_STRIPS == 0, "NUM_LEDS must divide evenly into NUM_STRIPS");
+
+#if defined(PARALLEL_OUTPUT) || defined(ESP32)
+#define OUTPUT_CONCURRENT 1
+#else
+#define OUTPUT_CONCURRENT 0
+#endif
+
+// WS2812 timing: 24 bits per pixel at 1.25 us per bit, plus the latch gap after each push
+#define PIXEL_PUSH_NS 30000UL
+#define LATCH_MICROS 50
+
+// Two-stage pipeline for dual-core boards (ESP32)
+// Effects keep rendering into leds[] on the loop() core, since many of them
+// build on the previous frame. Each finished frame is copied into whichever of
+// two output buffers is not being pushed, and its index is handed to an output
+// task on the other core. Rendering frame N+1 then overlaps pushing frame N.
+// The handoff is a single-producer/single-consumer flag pair, no locks.
+
+#ifdef DUAL_CORE_PIPELINE
+
+#ifndef ESP32
+#error "DUAL_CORE_PIPELINE needs a dual-core ESP32"
+#endif
+
+#ifdef PARALLEL_OUTPUT
+#error "DUAL_CORE_PIPELINE drives separate strip controllers, undefine PARALLEL_OUTPUT"
+#endif
+
+#define OUTPUT_CORE 0
+#define OUTPUT_TASK_STACK 2048
+#define OUTPUT_TASK_PRIORITY 2
+
+CRGB outputBuffers[2][NUM_LEDS];
+volatile byte frontBuffer = 0;       // index of the most recently published frame
+volatile boolean frameTaken = true;  // output task has picked up frontBuffer
+TaskHandle_t outputTask = NULL;
+
+// Runs on OUTPUT_CORE, pushes each published frame
+void outputLoop(void * /*params*/) {
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY); // sleep until a frame is published
+
+    CRGB *frame = outputBuffers[frontBuffer];
+    for (byte s = 0; s < NUM_STRIPS; s++) {
+      FastLED[s].setLeds(frame + s * STRIP_LEDS, STRIP_LEDS);
+    }
+    frameTaken = true; // the renderer may now fill the other buffer
+    FastLED.show();
+  }
+}
+
+void setupPipeline() {
+  xTaskCreatePinnedToCore(outputLoop, "output", OUTPUT_TASK_STACK, NULL,
+                          OUTPUT_TASK_PRIORITY, &outputTask, OUTPUT_CORE);
+}
+
+#endif
+
+// Register the strips with FastLED, called once from setup()
+void setupOutput() {
+#ifdef PARALLEL_OUTPUT
+  FastLED.addLeds<PARALLEL_OUTPUT, NUM_STRIPS, COLOR_ORDER>(leds, STRIP_LEDS);
+#else
+  FastLED.addLeds<CHIPSET, LED_PIN, COLOR_ORDER>(leds, 0 * STRIP_LEDS, STRIP_LEDS);
+#if NUM_STRIPS > 1
+  FastLED.addLeds<CHIPSET, LED_PIN_2, COLOR_ORDER>(leds, 1 * STRIP_LEDS, STRIP_LEDS);
+#endif
+#if NUM_STRIPS > 2
+  FastLED.addLeds<CHIPSET, LED_PIN_3, COLOR_ORDER>(leds, 2 * STRIP_LEDS, STRIP_LEDS);
+#endif
+#if NUM_STRIPS > 3
+  FastLED.addLeds<CHIPSET, LED_PIN_4, COLOR_ORDER>(leds, 3 * STRIP_LEDS, STRIP_LEDS);
+#endif
+#if NUM_STRIPS > 4
+#error "Up to 4 separate data pins are supported, use PARALLEL_OUTPUT for more"
+#endif
+#endif
+
+#ifdef DUAL_CORE_PIPELINE
+  setupPipeline();
+#endif
+}
+
+// Timing model: microseconds needed to push one frame to the LEDs
+unsigned long outputPushMicros() {
+  unsigned long stripMicros = STRIP_LEDS * PIXEL_PUSH_NS / 1000 + LATCH_MICROS;
+#if OUTPUT_CONCURRENT
+  return stripMicros;
+#else
+  return stripMicros * NUM_STRIPS;
+#endif
+}
+
+// Timing model: best frame rate for a frame that takes renderMicros to draw
+unsigned int outputMaxFPS(unsigned long renderMicros) {
+#ifdef DUAL_CORE_PIPELINE
+  // render and push overlap, the slower stage sets the pace
+  return 1000000UL / max(outputPushMicros(), renderMicros);
+#else
+  return 1000000UL / (outputPushMicros() + renderMicros);
+#endif
+}
+
+// Send the contents of leds[] to the LEDs
+void showFrame() {
+#ifdef DUAL_CORE_PIPELINE
+  // only wait if rendering has got a whole frame ahead of the output
+  while (!frameTaken) yield();
+
+  byte backBuffer = frontBuffer ^ 1;
+  memcpy(outputBuffers[backBuffer], leds, sizeof(outputBuffers[backBuffer]));
+  frameTaken = false;
+  frontBuffer = backBuffer;
+  xTaskNotifyGive(outputTask);
+#else
+  FastLED.show();
+#endif
+}
@@ -0,0 +1,114 @@
+// Polar coordinates of every canvas pixel, built by the compiler
+// polarAngle(x, y) is the direction from the canvas centre, 0-255 for a full
+// turn counterclockwise from +x, and polarRadius(x, y) is the distance from
+// the centre, 0-255 where 255 is a corner. polarDepth() turns a radius into
+// the depth of a tunnel wall seen down its axis, 255 at the centre.
+// The tables live in PROGMEM and follow kMatrixWidth and kMatrixHeight, so
+// radial effects need only lookups and sin8 at run time.
+//
+// C++11 constexpr functions must be a single return statement, hence the
+// recursion and the hand made index sequence (there is no STL on AVR).
+
+#define POLAR_TWO_PI 6.2831853f
+#define POLAR_HALF_PI 1.5707963f
+#define POLAR_DEPTH_SCALE 16 // radius at which the tunnel depth has halved
+
+constexpr float polarAbs(float v) {
+  return v < 0 ? -v : v;
+}
+
+constexpr float polarSqrtStep(float v, float guess, byte steps) {
+  return steps == 0 ? guess : polarSqrtStep(v, (guess + v / guess) / 2, steps - 1);
+}
+
+constexpr float polarSqrt(float v) {
+  return v <= 0 ? 0 : polarSqrtStep(v, v < 1 ? 1 : v, 24);
+}
+
+// atan for |t| <= 1, within 0.004 radians
+constexpr float polarAtan(float t) {
+  return 0.7853982f * t + 0.273f * t * (1 - polarAbs(t));
+}
+
+constexpr float polarAtan2(float y, float x) {
+  return (x == 0 && y == 0) ? 0 :
+         (polarAbs(x) >= polarAbs(y)) ?
+         (x > 0 ? polarAtan(y / x) : (y >= 0 ? polarAtan(y / x) + POLAR_TWO_PI / 2 : polarAtan(y / x) - POLAR_TWO_PI / 2)) :
+         (y > 0 ? POLAR_HALF_PI - polarAtan(x / y) : -POLAR_HALF_PI - polarAtan(x / y));
+}
+
+constexpr float polarDX(uint16_t i) {
+  return (float)(i % kMatrixWidth) - (kMatrixWidth - 1) / 2.0f;
+}
+
+constexpr float polarDY(uint16_t i) {
+  return (float)(i / kMatrixWidth) - (kMatrixHeight - 1) / 2.0f;
+}
+
+constexpr float polarMaxRadius() {
+  return polarSqrt(((kMatrixWidth - 1) / 2.0f) * ((kMatrixWidth - 1) / 2.0f) +
+                   ((kMatrixHeight - 1) / 2.0f) * ((kMatrixHeight - 1) / 2.0f));
+}
+
+constexpr byte polarAngleAt(uint16_t i) {
+  return (byte)((int16_t)(polarAtan2(polarDY(i), polarDX(i)) * (256 / POLAR_TWO_PI) + 256.5f) & 0xFF);
+}
+
+constexpr byte polarRadiusAt(uint16_t i) {
+  return (byte)(polarSqrt(polarDX(i) * polarDX(i) + polarDY(i) * polarDY(i)) * 255 / polarMaxRadius() + 0.5f);
+}
+
+constexpr byte polarDepthAt(uint16_t r) {
+  return (byte)(255L * POLAR_DEPTH_SCALE / (r + POLAR_DEPTH_SCALE));
+}
+
+// Compile time index sequence 0..N-1, built by halving so the template depth stays small
+template <uint16_t... Is> struct PolarIndices {};
+
+template <class A, class B> struct PolarJoin;
+template <uint16_t... A, uint16_t... B> struct PolarJoin<PolarIndices<A...>, PolarIndices<B...> > {
+  typedef PolarIndices < A..., (sizeof...(A) + B)... > type;
+};
+
+template <uint16_t N> struct PolarRange {
+  typedef typename PolarJoin < typename PolarRange < N / 2 >::type, typename PolarRange < N - N / 2 >::type >::type type;
+};
+template <> struct PolarRange<0> {
+  typedef PolarIndices<> type;
+};
+template <> struct PolarRange<1> {
+  typedef PolarIndices<0> type;
+};
+
+struct PolarTable {
+  byte angle[NUM_LEDS];
+  byte radius[NUM_LEDS];
+};
+
+struct PolarDepthTable {
+  byte depth[256];
+};
+
+template <uint16_t... Is> constexpr PolarTable polarBuild(PolarIndices<Is...>) {
+  return PolarTable{ {polarAngleAt(Is)...}, {polarRadiusAt(Is)...} };
+}
+
+template <uint16_t... Is> constexpr PolarDepthTable polarDepthBuild(PolarIndices<Is...>) {
+  return PolarDepthTable{ {polarDepthAt(Is)...} };
+}
+
+// Indexed by canvas position (y * kMatrixWidth + x), not by LED
+constexpr PolarTable polarMap PROGMEM = polarBuild(PolarRange<NUM_LEDS>::type());
+constexpr PolarDepthTable polarDepthMap PROGMEM = polarDepthBuild(PolarRange<256>::type());
+
+inline byte polarAngle(byte x, byte y) {
+  return pgm_read_byte(&polarMap.angle[y * kMatrixWidth + x]);
+}
+
+inline byte polarRadius(byte x, byte y) {
+  return pgm_read_byte(&polarMap.radius[y * kMatrixWidth + x]);
+}
+
+inline byte polarDepth(byte radius) {
+  return pgm_read_byte(&polarDepthMap.depth[radius]);
+}
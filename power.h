@@ -0,0 +1,215 @@
+// Idle and night power saving
+// With POWER_SAVE defined the unit goes dark after POWER_IDLE_TIMEOUT without
+// a button press, and every day for the hours after POWER_ON_HOURS counted
+// from power up (there is no clock, so plug it in at the time it should
+// start). The output brightness is faded to zero over POWER_FADE_MILLIS,
+// one black frame is sent and after that show() is not called at all.
+//
+// While dark the MCU sleeps as deeply as it can and still keep its state:
+//   AVR    power-down, woken by the watchdog, or a pin change on SW1/SW2 on
+//          ATmega328/168 (others poll the buttons every POWER_WDT_MILLIS)
+//   ESP32  light sleep, woken by SW1/SW2 or a timer
+//   others no sleep, the buttons are polled every POWER_POLL_MILLIS
+// A press wakes the unit and is not taken as a command; at night it stays
+// on for POWER_NIGHT_WAKE before going dark again. The schedule keeps its own
+// time of day, so it doesn't shift when millis() wraps every 49.7 days.
+//
+// millis() stops in AVR power-down, so the time asleep is added up from
+// watchdog periods (within about 10%) and added to currentMillis.
+// powerSleepMillis and powerSleeps count the time asleep and the wake ups,
+// for working out the average current. The generic sleep below waits through
+// powerSleepHook when one is set, so a host build can move its mocked clock
+// on and press buttons meanwhile; tools/host/powertest.cpp works out the
+// average current and the wake latency that way. WS2812 LEDs keep drawing
+// about 0.6 mA each while black, so on a 16x16 canvas the strip, not the MCU,
+// sets the current while dark unless its supply is switched off.
+
+#ifdef POWER_SAVE
+
+#ifndef POWER_IDLE_TIMEOUT
+#define POWER_IDLE_TIMEOUT (4 * 3600000UL) // ms without a button press
+#endif
+#define POWER_ON_HOURS 6                   // hours on in every 24, 24 disables the schedule
+#define POWER_NIGHT_WAKE 300000UL          // ms a press keeps it on at night
+#define POWER_FADE_MILLIS 3000
+#define POWER_WAKE_MILLIS 8000             // longest sleep between schedule checks
+#define POWER_POLL_MILLIS 10               // button polling while asleep, boards without a wake interrupt
+
+#if defined(__AVR__)
+#include <avr/sleep.h>
+#include <avr/wdt.h>
+#elif defined(ESP32)
+#include <esp_sleep.h>
+#endif
+
+#define POWER_ON 0
+#define POWER_FADING 1
+#define POWER_ASLEEP 2
+
+byte powerState = POWER_ON;
+unsigned long powerActivity = 0;       // time of the last button press
+unsigned long powerFadeStart = 0;
+unsigned long powerDayMillis = 0;      // time since the schedule's day started
+unsigned long powerLastMillis = 0;
+unsigned long powerSlept = 0;          // time asleep that millis() missed
+unsigned long powerSleepMillis = 0;    // total time asleep
+unsigned long powerSleeps = 0;         // times the MCU went to sleep
+volatile boolean powerButtonWoke = false;
+
+boolean powerButtonsDown() {
+  return getStartupButtons() != 0b11;
+}
+
+// Move the schedule's time of day on to currentMillis
+void powerClock() {
+  powerDayMillis += currentMillis - powerLastMillis;
+  powerLastMillis = currentMillis;
+  if (powerDayMillis >= 24 * 3600000UL) {
+    powerDayMillis -= 24 * 3600000UL;
+    if (POWER_ON_HOURS < 24) powerActivity = currentMillis; // morning, come on as if pressed
+  }
+}
+
+// True when the schedule says it's night
+boolean powerNight() {
+  return powerDayMillis >= POWER_ON_HOURS * 3600000UL;
+}
+
+boolean powerIdle() {
+  unsigned long sinceActivity = currentMillis - powerActivity;
+  if (sinceActivity > POWER_IDLE_TIMEOUT) return true;
+  return powerNight() && sinceActivity > POWER_NIGHT_WAKE;
+}
+
+void powerRestoreBrightness() {
+  FastLED.setBrightness(scale8(currentBrightness, MAXBRIGHTNESS));
+}
+
+#if defined(__AVR__)
+ISR(WDT_vect) {}
+
+#if defined(__AVR_ATmega328P__) || defined(__AVR_ATmega168__)
+ISR(PCINT2_vect) {
+  powerButtonWoke = true;
+}
+
+// Pin change interrupts on the button pins, only needed while asleep
+void powerButtonWake(boolean enable) {
+  byte mask = bit(digitalPinToPCMSKbit(MODEBUTTON)) | bit(digitalPinToPCMSKbit(BRIGHTNESSBUTTON));
+  if (enable) {
+    *digitalPinToPCMSK(MODEBUTTON) |= mask;
+    PCIFR = bit(digitalPinToPCICRbit(MODEBUTTON));
+    *digitalPinToPCICR(MODEBUTTON) |= bit(digitalPinToPCICRbit(MODEBUTTON));
+  } else {
+    *digitalPinToPCMSK(MODEBUTTON) &= ~mask;
+  }
+}
+#define POWER_WDT WDTO_8S
+#define POWER_WDT_MILLIS 8000
+#else
+void powerButtonWake(boolean) {} // no pin change interrupt on these pins, poll faster
+#define POWER_WDT WDTO_250MS
+#define POWER_WDT_MILLIS 250
+#endif
+
+void powerSleep() {
+  byte adc = ADCSRA;
+  ADCSRA = 0; // the ADC draws current in power-down if left on
+  powerButtonWoke = false;
+  powerButtonWake(true);
+
+  cli();
+  MCUSR &= ~bit(WDRF);
+  WDTCSR = bit(WDCE) | bit(WDE);
+  WDTCSR = bit(WDIE) | ((POWER_WDT & 8) ? bit(WDP3) : 0) | (POWER_WDT & 7); // interrupt only, no reset
+  set_sleep_mode(SLEEP_MODE_PWR_DOWN);
+  sleep_enable();
+#ifdef sleep_bod_disable
+  sleep_bod_disable();
+#endif
+  sei();
+  sleep_cpu();
+  sleep_disable();
+  wdt_disable();
+
+  powerButtonWake(false);
+  ADCSRA = adc;
+  if (!powerButtonWoke) powerSlept += POWER_WDT_MILLIS; // a button wake loses part of a period
+}
+
+#elif defined(ESP32)
+void powerSleep() {
+  esp_sleep_enable_timer_wakeup(POWER_WAKE_MILLIS * 1000ULL);
+  gpio_wakeup_enable((gpio_num_t)MODEBUTTON, GPIO_INTR_LOW_LEVEL);
+  gpio_wakeup_enable((gpio_num_t)BRIGHTNESSBUTTON, GPIO_INTR_LOW_LEVEL);
+  esp_sleep_enable_gpio_wakeup();
+  esp_light_sleep_start(); // millis() keeps counting
+}
+
+#else
+void (*powerSleepHook)(unsigned long ms) = NULL; // waits instead of delay() when set
+
+void powerSleep() {
+  unsigned long start = millis();
+  while (millis() - start < POWER_WAKE_MILLIS && !powerButtonsDown()) {
+    if (powerSleepHook) powerSleepHook(POWER_POLL_MILLIS);
+    else delay(POWER_POLL_MILLIS);
+  }
+}
+#endif
+
+// Run the power states, true while the unit is dark and the loop has nothing to do
+boolean powerSaving() {
+  powerClock();
+  if (powerButtonsDown()) powerActivity = currentMillis;
+
+  switch (powerState) {
+    case POWER_ON:
+      if (powerIdle()) {
+        powerState = POWER_FADING;
+        powerFadeStart = currentMillis;
+      }
+      return false;
+
+    case POWER_FADING: {
+      if (!powerIdle()) {
+        powerState = POWER_ON;
+        powerRestoreBrightness();
+        return false;
+      }
+
+      unsigned long fade = currentMillis - powerFadeStart;
+      if (fade < POWER_FADE_MILLIS) {
+        FastLED.setBrightness(scale8(scale8(currentBrightness, MAXBRIGHTNESS), 255 - fade * 255 / POWER_FADE_MILLIS));
+        return false;
+      }
+
+      FastLED.setBrightness(0);
+      showFrame(); // the last frame, black
+      if (eepromOutdated) {
+        saveEEPROMvals(); // don't leave it for later
+        eepromOutdated = false;
+      }
+      powerState = POWER_ASLEEP;
+      return true;
+    }
+
+    case POWER_ASLEEP: {
+      if (!powerIdle()) {
+        powerState = POWER_ON;
+        powerRestoreBrightness();
+        initialized = false; // wait for the wake press to end before reading buttons
+        return false;
+      }
+
+      unsigned long start = millis() + powerSlept;
+      powerSleep();
+      powerSleepMillis += millis() + powerSlept - start;
+      powerSleeps++;
+      return true;
+    }
+  }
+  return false;
+}
+
+#endif
@@ -0,0 +1,216 @@
+// Shape drawing into the LED array
+// Lines, circles and polygons take 8.8 fixed point coordinates where a whole
+// number is the centre of a pixel, so FIX88(3) is pixel 3 and FIX88(3) + 128
+// sits halfway between pixels 3 and 4. Rectangles are given in whole pixels.
+// Everything is clipped to the canvas. Fills are emitted as horizontal spans,
+// which are written with a plain pointer walk when the layout stores rows
+// contiguously.
+
+typedef int16_t fix88;
+#define FIX88(v) ((fix88)((v) * 256))
+#define MAX_POLYGON_POINTS 8
+
+void drawPixel(int16_t x, int16_t y, CRGB color) {
+  if (x >= 0 && x < kMatrixWidth && y >= 0 && y < kMatrixHeight) leds[XY(x, y)] = color;
+}
+
+// Blend color into a pixel by alpha (0-255)
+void blendPixel(int16_t x, int16_t y, CRGB color, byte alpha) {
+  if (x >= 0 && x < kMatrixWidth && y >= 0 && y < kMatrixHeight) {
+#ifdef DEEP_COLOR
+    deepBlend(XY(x, y), color, alpha); // keeps the fraction of a fading trail
+#else
+    nblend(leds[XY(x, y)], color, alpha);
+#endif
+  }
+}
+
+// Fill pixels x0..x1 (inclusive) of row y
+void drawSpan(int16_t x0, int16_t x1, int16_t y, CRGB color) {
+  if (y < 0 || y >= kMatrixHeight) return;
+  if (x0 < 0) x0 = 0;
+  if (x1 >= kMatrixWidth) x1 = kMatrixWidth - 1;
+  if (x0 > x1) return;
+
+  if (xyRowsContiguous()) {
+    CRGB *pixel = &leds[XY(x0, y)];
+    for (int16_t n = x1 - x0; n >= 0; n--) *pixel++ = color;
+  } else {
+    for (int16_t x = x0; x <= x1; x++) leds[XY(x, y)] = color;
+  }
+}
+
+void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, CRGB color) {
+  for (int16_t row = y; row < y + h; row++) drawSpan(x, x + w - 1, row, color);
+}
+
+void drawRect(int16_t x, int16_t y, int16_t w, int16_t h, CRGB color) {
+  drawSpan(x, x + w - 1, y, color);
+  drawSpan(x, x + w - 1, y + h - 1, color);
+  for (int16_t row = y + 1; row < y + h - 1; row++) {
+    drawPixel(x, row, color);
+    drawPixel(x + w - 1, row, color);
+  }
+}
+
+// Bresenham line between the pixels nearest to each end point
+void drawLine(fix88 fx0, fix88 fy0, fix88 fx1, fix88 fy1, CRGB color) {
+  int16_t x0 = (fx0 + 128) >> 8;
+  int16_t y0 = (fy0 + 128) >> 8;
+  int16_t x1 = (fx1 + 128) >> 8;
+  int16_t y1 = (fy1 + 128) >> 8;
+
+  int16_t dx = abs(x1 - x0);
+  int16_t dy = -abs(y1 - y0);
+  int8_t sx = (x0 < x1) ? 1 : -1;
+  int8_t sy = (y0 < y1) ? 1 : -1;
+  int16_t err = dx + dy;
+
+  for (;;) {
+    drawPixel(x0, y0, color);
+    if (x0 == x1 && y0 == y1) break;
+    int16_t e2 = err * 2;
+    if (e2 >= dy) {
+      err += dy;
+      x0 += sx;
+    }
+    if (e2 <= dx) {
+      err += dx;
+      y0 += sy;
+    }
+  }
+}
+
+// Xiaolin Wu anti-aliased line, each step splits the color across two pixels
+void drawLineAA(fix88 x0, fix88 y0, fix88 x1, fix88 y1, CRGB color) {
+  boolean steep = abs(y1 - y0) > abs(x1 - x0);
+  fix88 t;
+  if (steep) {
+    t = x0; x0 = y0; y0 = t;
+    t = x1; x1 = y1; y1 = t;
+  }
+  if (x0 > x1) {
+    t = x0; x0 = x1; x1 = t;
+    t = y0; y0 = y1; y1 = t;
+  }
+
+  int16_t dx = x1 - x0;
+  int32_t gradient = dx ? ((int32_t)(y1 - y0) * 256) / dx : 0; // 8.8 rise per pixel
+  int16_t xStart = (x0 + 128) >> 8;
+  int16_t xEnd = (x1 + 128) >> 8;
+  int32_t y = y0 + (((int32_t)xStart * 256 - x0) * gradient >> 8);
+
+  for (int16_t x = xStart; x <= xEnd; x++) {
+    int16_t iy = y >> 8;
+    byte frac = y & 0xFF;
+    if (steep) {
+      blendPixel(iy, x, color, 255 - frac);
+      blendPixel(iy + 1, x, color, frac);
+    } else {
+      blendPixel(x, iy, color, 255 - frac);
+      blendPixel(x, iy + 1, color, frac);
+    }
+    y += gradient;
+  }
+}
+
+// Midpoint circle around the nearest pixel to the centre, radius rounded to whole pixels
+void drawCircle(fix88 fcx, fix88 fcy, fix88 fr, CRGB color) {
+  int16_t cx = (fcx + 128) >> 8;
+  int16_t cy = (fcy + 128) >> 8;
+  int16_t x = (fr + 128) >> 8;
+  int16_t y = 0;
+  int16_t err = 1 - x;
+
+  while (x >= y) {
+    drawPixel(cx + x, cy + y, color);
+    drawPixel(cx - x, cy + y, color);
+    drawPixel(cx + x, cy - y, color);
+    drawPixel(cx - x, cy - y, color);
+    drawPixel(cx + y, cy + x, color);
+    drawPixel(cx - y, cy + x, color);
+    drawPixel(cx + y, cy - x, color);
+    drawPixel(cx - y, cy - x, color);
+    y++;
+    if (err < 0) {
+      err += 2 * y + 1;
+    } else {
+      x--;
+      err += 2 * (y - x) + 1;
+    }
+  }
+}
+
+void fillCircle(fix88 fcx, fix88 fcy, fix88 fr, CRGB color) {
+  int16_t cx = (fcx + 128) >> 8;
+  int16_t cy = (fcy + 128) >> 8;
+  int16_t x = (fr + 128) >> 8;
+  int16_t y = 0;
+  int16_t err = 1 - x;
+
+  while (x >= y) {
+    drawSpan(cx - x, cx + x, cy + y, color);
+    drawSpan(cx - x, cx + x, cy - y, color);
+    drawSpan(cx - y, cx + y, cy + x, color);
+    drawSpan(cx - y, cx + y, cy - x, color);
+    y++;
+    if (err < 0) {
+      err += 2 * y + 1;
+    } else {
+      x--;
+      err += 2 * (y - x) + 1;
+    }
+  }
+}
+
+// Scanline fill with the even-odd rule, a pixel is inside if its centre is
+void fillPolygon(const fix88 *xs, const fix88 *ys, byte count, CRGB color) {
+  if (count < 3 || count > MAX_POLYGON_POINTS) return;
+
+  fix88 top = ys[0], bottom = ys[0];
+  for (byte i = 1; i < count; i++) {
+    if (ys[i] < top) top = ys[i];
+    if (ys[i] > bottom) bottom = ys[i];
+  }
+
+  int16_t firstRow = (top + 255) >> 8;
+  int16_t lastRow = bottom >> 8;
+  if (firstRow < 0) firstRow = 0;
+  if (lastRow >= kMatrixHeight) lastRow = kMatrixHeight - 1;
+
+  // 8.8 change in x per row for every edge, worked out once
+  int32_t slopes[MAX_POLYGON_POINTS];
+  for (byte i = 0; i < count; i++) {
+    byte j = (i + 1 < count) ? i + 1 : 0;
+    int16_t dy = ys[j] - ys[i];
+    slopes[i] = dy ? ((int32_t)(xs[j] - xs[i]) * 256) / dy : 0;
+  }
+
+  fix88 crossings[MAX_POLYGON_POINTS];
+  for (int16_t row = firstRow; row <= lastRow; row++) {
+    fix88 rowY = row << 8;
+    byte found = 0;
+
+    for (byte i = 0; i < count; i++) {
+      byte j = (i + 1 < count) ? i + 1 : 0;
+      // half-open test so shared vertices are only counted once
+      if ((ys[i] <= rowY && ys[j] > rowY) || (ys[j] <= rowY && ys[i] > rowY)) {
+        // step down from the upper end so the vertex itself is exact
+        byte upper = (ys[i] < ys[j]) ? i : j;
+        fix88 x = xs[upper] + (((int32_t)(rowY - ys[upper]) * slopes[i]) >> 8);
+
+        // insertion sort, there are only a handful of crossings
+        byte k = found++;
+        while (k > 0 && crossings[k - 1] > x) {
+          crossings[k] = crossings[k - 1];
+          k--;
+        }
+        crossings[k] = x;
+      }
+    }
+
+    for (byte k = 0; k + 1 < found; k += 2) {
+      drawSpan((crossings[k] + 255) >> 8, ((crossings[k + 1] + 255) >> 8) - 1, row, color);
+    }
+  }
+}
@@ -0,0 +1,200 @@
+// Fixed point 3D for wireframe and starfield effects
+// Points are 8.8 fixed point (see raster.h), one unit is FIX88(1). The camera
+// sits at the origin looking down +z with +y up; render3DProject() puts a
+// point in front of it on the canvas, RENDER3D_FOCAL pixels per unit of x or y
+// at a distance of one unit. Rotations come from rotation3D(), built from a
+// quarter wave sine table, and the perspective divide looks the reciprocal
+// of the depth up in a table after shifting it into 128-255, so there is no
+// division per point. Points nearer than RENDER3D_NEAR, or so far off the
+// canvas that the 8.8 screen position would not hold them, are not drawn.
+//
+// Solids are kept in PROGMEM as vertex and edge lists, vertices in 2.6 fixed
+// point (64 is one unit) to keep them small.
+
+#define RENDER3D_FOCAL (kMatrixWidth / 2)
+#define RENDER3D_NEAR FIX88(0.5)
+#define RENDER3D_REACH FIX88(64) // farthest a projected point may be from the centre, in pixels
+
+struct Point3D {
+  fix88 x;
+  fix88 y;
+  fix88 z;
+};
+
+// Rotation matrix, 8.8 fixed point, row by row
+struct Matrix3D {
+  int16_t m[9];
+};
+
+// sin() of 0-63 of 256 steps to a turn, 8.8 with 1.0 stored as 255
+const uint8_t PROGMEM sine3DTable[64] = {
+  0, 6, 13, 19, 25, 31, 38, 44, 50, 56, 62, 68, 74, 80, 86, 92,
+  98, 104, 109, 115, 121, 126, 132, 137, 142, 147, 152, 157, 162, 167, 172, 177,
+  181, 185, 190, 194, 198, 202, 206, 209, 213, 216, 220, 223, 226, 229, 231, 234,
+  237, 239, 241, 243, 245, 247, 248, 250, 251, 252, 253, 254, 255, 255, 255, 255,
+};
+
+// 65536 / m for m from 128 to 255
+const uint16_t PROGMEM reciprocal3DTable[128] = {
+  512, 508, 504, 500, 496, 493, 489, 485, 482, 478, 475, 471, 468, 465, 462, 458,
+  455, 452, 449, 446, 443, 440, 437, 434, 431, 428, 426, 423, 420, 417, 415, 412,
+  410, 407, 405, 402, 400, 397, 395, 392, 390, 388, 386, 383, 381, 379, 377, 374,
+  372, 370, 368, 366, 364, 362, 360, 358, 356, 354, 352, 350, 349, 347, 345, 343,
+  341, 340, 338, 336, 334, 333, 331, 329, 328, 326, 324, 323, 321, 320, 318, 317,
+  315, 314, 312, 311, 309, 308, 306, 305, 303, 302, 301, 299, 298, 297, 295, 294,
+  293, 291, 290, 289, 287, 286, 285, 284, 282, 281, 280, 279, 278, 277, 275, 274,
+  273, 272, 271, 270, 269, 267, 266, 265, 264, 263, 262, 261, 260, 259, 258, 257,
+};
+
+// sin and cos of angle (256 to a turn) in 8.8
+int16_t sin3D(byte angle) {
+  byte i = angle & 63;
+  int16_t v;
+  if (angle & 64) {
+    v = i ? pgm_read_byte(&sine3DTable[64 - i]) : 256; // falling quarter
+  } else {
+    v = pgm_read_byte(&sine3DTable[i]);
+  }
+  return (angle & 128) ? -v : v;
+}
+
+inline int16_t cos3D(byte angle) {
+  return sin3D(angle + 64);
+}
+
+inline int16_t mul3D(int16_t a, int16_t b) {
+  return ((int32_t)a * b) >> 8;
+}
+
+// Turn by pitch about x, then yaw about y, then roll about z
+void rotation3D(Matrix3D &r, byte pitch, byte yaw, byte roll) {
+  int16_t sx = sin3D(pitch), cx = cos3D(pitch);
+  int16_t sy = sin3D(yaw), cy = cos3D(yaw);
+  int16_t sz = sin3D(roll), cz = cos3D(roll);
+  int16_t sysx = mul3D(sy, sx);
+  int16_t sycx = mul3D(sy, cx);
+
+  r.m[0] = mul3D(cz, cy);
+  r.m[1] = mul3D(cz, sysx) - mul3D(sz, cx);
+  r.m[2] = mul3D(cz, sycx) + mul3D(sz, sx);
+  r.m[3] = mul3D(sz, cy);
+  r.m[4] = mul3D(sz, sysx) + mul3D(cz, cx);
+  r.m[5] = mul3D(sz, sycx) - mul3D(cz, sx);
+  r.m[6] = -sy;
+  r.m[7] = mul3D(cy, sx);
+  r.m[8] = mul3D(cy, cx);
+}
+
+Point3D transform3D(const Matrix3D &r, const Point3D &p) {
+  Point3D t;
+  t.x = ((int32_t)r.m[0] * p.x + (int32_t)r.m[1] * p.y + (int32_t)r.m[2] * p.z) >> 8;
+  t.y = ((int32_t)r.m[3] * p.x + (int32_t)r.m[4] * p.y + (int32_t)r.m[5] * p.z) >> 8;
+  t.z = ((int32_t)r.m[6] * p.x + (int32_t)r.m[7] * p.y + (int32_t)r.m[8] * p.z) >> 8;
+  return t;
+}
+
+// Canvas position of a point, false if it can't be drawn
+boolean render3DProject(const Point3D &p, fix88 &sx, fix88 &sy) {
+  if (p.z < RENDER3D_NEAR) return false;
+
+  // z = m << n with m in 128-255, so x / z in 8.8 is (x * 65536 / m) >> (8 + n)
+  uint16_t m = p.z;
+  byte shift = 8;
+  while (m >= 256) {
+    m >>= 1;
+    shift++;
+  }
+  uint16_t reciprocal = pgm_read_word(&reciprocal3DTable[m - 128]);
+
+  int32_t x = ((int32_t)p.x * reciprocal >> shift) * RENDER3D_FOCAL;
+  int32_t y = ((int32_t)p.y * reciprocal >> shift) * RENDER3D_FOCAL;
+  if (x > RENDER3D_REACH || x < -RENDER3D_REACH || y > RENDER3D_REACH || y < -RENDER3D_REACH) return false;
+
+  sx = FIX88(kMatrixWidth - 1) / 2 + x;
+  sy = FIX88(kMatrixHeight - 1) / 2 - y; // canvas y grows downwards
+  return true;
+}
+
+// 255 up to depth near, fading out to 0 at depth far
+byte render3DFade(fix88 z, fix88 near, fix88 far) {
+  if (z <= near) return 255;
+  if (z >= far) return 0;
+  return 255 - (((int32_t)(z - near) * 255) / (far - near));
+}
+
+// Wireframe solids
+#define SOLIDS_3D 3
+#define SOLID_MAX_VERTICES 8
+
+struct Solid3D {
+  const int8_t *vertices; // x, y, z per vertex, 2.6 fixed point
+  byte vertexCount;
+  const byte *edges;      // vertex pairs
+  byte edgeCount;
+};
+
+const int8_t PROGMEM cubeVertices[] = {
+  -56, -56, -56,   56, -56, -56,   56, 56, -56,   -56, 56, -56,
+  -56, -56, 56,    56, -56, 56,    56, 56, 56,    -56, 56, 56,
+};
+const byte PROGMEM cubeEdges[] = {
+  0, 1,  1, 2,  2, 3,  3, 0,  4, 5,  5, 6,  6, 7,  7, 4,  0, 4,  1, 5,  2, 6,  3, 7,
+};
+
+const int8_t PROGMEM octahedronVertices[] = {
+  96, 0, 0,   -96, 0, 0,   0, 96, 0,   0, -96, 0,   0, 0, 96,   0, 0, -96,
+};
+const byte PROGMEM octahedronEdges[] = {
+  0, 2,  0, 3,  0, 4,  0, 5,  1, 2,  1, 3,  1, 4,  1, 5,  2, 4,  4, 3,  3, 5,  5, 2,
+};
+
+const int8_t PROGMEM tetrahedronVertices[] = {
+  60, 60, 60,   60, -60, -60,   -60, 60, -60,   -60, -60, 60,
+};
+const byte PROGMEM tetrahedronEdges[] = {
+  0, 1,  0, 2,  0, 3,  1, 2,  1, 3,  2, 3,
+};
+
+void solid3D(byte n, Solid3D &s) {
+  switch (n) {
+    case 0:
+      s = {cubeVertices, 8, cubeEdges, 12};
+      break;
+
+    case 1:
+      s = {octahedronVertices, 6, octahedronEdges, 12};
+      break;
+
+    default:
+      s = {tetrahedronVertices, 4, tetrahedronEdges, 6};
+      break;
+  }
+}
+
+// Draw a solid turned by r and moved depth units away, with anti-aliased edges
+void drawSolid3D(const Solid3D &s, const Matrix3D &r, fix88 depth, byte hue) {
+  fix88 xs[SOLID_MAX_VERTICES], ys[SOLID_MAX_VERTICES], zs[SOLID_MAX_VERTICES];
+  byte shown = 0; // bit per vertex that could be projected
+
+  for (byte i = 0; i < s.vertexCount; i++) {
+    Point3D p = {
+      (fix88)((int8_t)pgm_read_byte(&s.vertices[i * 3]) * 4),
+      (fix88)((int8_t)pgm_read_byte(&s.vertices[i * 3 + 1]) * 4),
+      (fix88)((int8_t)pgm_read_byte(&s.vertices[i * 3 + 2]) * 4)
+    };
+    p = transform3D(r, p);
+    p.z += depth;
+    zs[i] = p.z;
+    if (render3DProject(p, xs[i], ys[i])) shown |= 1 << i;
+  }
+
+  for (byte e = 0; e < s.edgeCount; e++) {
+    byte a = pgm_read_byte(&s.edges[e * 2]);
+    byte b = pgm_read_byte(&s.edges[e * 2 + 1]);
+    if (!(shown & (1 << a)) || !(shown & (1 << b))) continue;
+
+    // edges further back are dimmer
+    byte level = render3DFade((zs[a] + zs[b]) / 2, depth - FIX88(1), depth + FIX88(2));
+    drawLineAA(xs[a], ys[a], xs[b], ys[b], ColorFromPalette(currentPalette, hue + e * 8, 64 + scale8(level, 191)));
+  }
+}
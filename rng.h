@@ -0,0 +1,92 @@
+// Fast random numbers for effects that use a lot of them
+// A 32-bit xorshift generator: three shifts and xors give four random bytes,
+// against a multiply per byte for random8(). Bounded values are scaled with
+// a multiply and shift instead of a division, the same as random8(lim), so
+// values below the limit come up with at most one count of difference.
+//
+//   rngFill(buffer, count)    fill a buffer, then rngMap(buffer[i], lim) per item
+//   rng8(), rng16()           single values, taken from the last 32 bits
+//   rngBelow8(lim), rngBelow16(lim), rngRange8(lo, hi)
+//
+// rngSeed() starts the same sequence again for the same seed, so a run can be
+// replayed; sync.h seeds it on every frame so followers draw the same noise.
+
+#define RNG_STATE 0x2545F491UL // state at power up, any but 0
+
+uint32_t rngState = RNG_STATE;
+uint32_t rngBits;   // unused bytes of the last step, low byte first
+byte rngBitsLeft;
+
+inline uint32_t rngNext() {
+  uint32_t x = rngState;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  rngState = x;
+  return x;
+}
+
+// Start the sequence for seed, different seeds give unrelated sequences
+void rngSeed(uint16_t seed) {
+  // hash the seed, so seeds a count apart don't start alike
+  uint32_t x = (seed + 1UL) * 0x9E3779B1UL;
+  x ^= x >> 16;
+  x *= 0x45D9F3BUL;
+  x ^= x >> 16;
+  rngState = x ? x : RNG_STATE;
+  rngBitsLeft = 0;
+}
+
+// Fill count bytes with random values
+void rngFill(byte *dest, uint16_t count) {
+  while (count >= 4) {
+    uint32_t x = rngNext();
+    dest[0] = x;
+    dest[1] = x >> 8;
+    dest[2] = x >> 16;
+    dest[3] = x >> 24;
+    dest += 4;
+    count -= 4;
+  }
+  if (count == 0) return;
+  uint32_t x = rngNext();
+  while (count--) {
+    *dest++ = x;
+    x >>= 8;
+  }
+}
+
+// A random byte scaled to 0 .. lim - 1
+inline byte rngMap(byte r, byte lim) {
+  return (r * lim) >> 8;
+}
+
+inline byte rng8() {
+  if (rngBitsLeft == 0) {
+    rngBits = rngNext();
+    rngBitsLeft = 4;
+  }
+  byte r = rngBits;
+  rngBits >>= 8;
+  rngBitsLeft--;
+  return r;
+}
+
+inline uint16_t rng16() {
+  uint16_t r = rng8();
+  return r | ((uint16_t)rng8() << 8);
+}
+
+// 0 .. lim - 1
+inline byte rngBelow8(byte lim) {
+  return rngMap(rng8(), lim);
+}
+
+inline uint16_t rngBelow16(uint16_t lim) {
+  return ((uint32_t)rng16() * lim) >> 16;
+}
+
+// lo .. hi - 1
+inline byte rngRange8(byte lo, byte hi) {
+  return lo + rngBelow8(hi - lo);
+}
@@ -0,0 +1,98 @@
+// Pixel shaders
+// Most effects draw every pixel from a formula of x, y and time. shade()
+// runs that double loop for them:
+//   shade(rowSetup, pixel);
+// calls rowSetup(y) once per canvas row and then pixel(x, y) for each pixel
+// of the row, storing what pixel() returns (CRGB or CHSV) into leds[]. Work
+// that only depends on the frame is done before the call and work that only
+// depends on the row in rowSetup, so pixel() is left with what changes along
+// the row. Lambdas that capture the effect's locals by reference fit well:
+//   byte rowPos;
+//   shade([&](byte y) { rowPos = y * 16 + slantPos; },
+//         [&](byte x, byte y) { return CHSV(cycleHue, 255, quadwave8(x * 16 + rowPos)); });
+//
+// The loop is put together at compile time for the layout in XYmap.h. A
+// single contiguous panel is written with a pointer walk in memory order.
+// On tiled canvases each panel's part of a row is walked in memory order with
+// a fixed step, only rotated serpentine panels need XY() per pixel. Pixels
+// are written SHADER_UNROLL at a time.
+//
+// shadeField() is the same for effects that draw through fieldPixel() (see
+// lowres.h): at half resolution it shades the grid and upscales it. The grid
+// reaches one past the right and bottom edges, so there rowSetup() and pixel()
+// are also called with y == kMatrixHeight or x == kMatrixWidth on even sized
+// canvases. Both must stay plain formulas that are fine one row or column out.
+
+#define SHADER_UNROLL 4
+
+static_assert(kTileWidth % SHADER_UNROLL == 0, "panel width must be a multiple of SHADER_UNROLL");
+
+// K copies of the pixel body for pixels x to x + K - 1, step entries apart in leds[]
+template <byte K>
+struct ShadeRun {
+  template <class Pixel>
+  static inline __attribute__((always_inline)) void run(CRGB *p, int16_t step, byte x, byte y, Pixel &pixel) {
+    ShadeRun<K - 1>::run(p, step, x, y, pixel);
+    p[(K - 1) * step] = pixel(x + K - 1, y);
+  }
+};
+
+template <>
+struct ShadeRun<0> {
+  template <class Pixel>
+  static inline __attribute__((always_inline)) void run(CRGB *, int16_t, byte, byte, Pixel &) {}
+};
+
+// Shade width pixels of row y from x, width a multiple of SHADER_UNROLL
+template <class Pixel>
+inline __attribute__((always_inline)) void shadeSpan(CRGB *p, int16_t step, byte x, byte y, byte width, Pixel &pixel) {
+  for (byte end = x + width; x != end; x += SHADER_UNROLL, p += SHADER_UNROLL * step) {
+    ShadeRun<SHADER_UNROLL>::run(p, step, x, y, pixel);
+  }
+}
+
+template <class RowSetup, class Pixel>
+void shade(RowSetup rowSetup, Pixel pixel) {
+  if (xyRowsContiguous()) {
+    CRGB *p = leds;
+    for (byte y = 0; y < kMatrixHeight; y++) {
+      rowSetup(y);
+      shadeSpan(p, 1, 0, y, kMatrixWidth, pixel);
+      p += kMatrixWidth;
+    }
+    return;
+  }
+
+  for (byte y = 0; y < kMatrixHeight; y++) {
+    rowSetup(y);
+    for (byte x = 0; x < kMatrixWidth; x += kTileWidth) {
+      const TileInfo &tile = tileMap[(y / kTileHeight) * kTilesX + (x / kTileWidth)];
+
+      if (tile.serpentine && (tile.rotation == ROTATE_90 || tile.rotation == ROTATE_270)) {
+        // the panel row zigzags through memory
+        for (byte tx = x; tx < x + kTileWidth; tx++) leds[XY(tx, y)] = pixel(tx, y);
+        continue;
+      }
+
+      uint16_t first = XY(x, y);
+      shadeSpan(&leds[first], (int16_t)(XY(x + 1, y) - first), x, y, kTileWidth, pixel);
+    }
+  }
+}
+
+#ifdef HALF_RES_FIELDS
+template <class RowSetup, class Pixel>
+void shadeField(RowSetup rowSetup, Pixel pixel) {
+  CRGB *p = lowRes;
+  for (byte y = 0; y < FIELD_HEIGHT; y += FIELD_STEP) {
+    rowSetup(y);
+    for (byte x = 0; x < FIELD_WIDTH; x += FIELD_STEP) *p++ = pixel(x, y);
+  }
+  fieldUpscale();
+}
+#else
+template <class RowSetup, class Pixel>
+inline void shadeField(RowSetup rowSetup, Pixel pixel) {
+  shade(rowSetup, pixel);
+}
+#endif
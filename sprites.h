@@ -0,0 +1,15 @@
+// Sprite sheets, regenerate with tools/png2sprite.py
+
+// Generated by tools/png2sprite.py from heart.png
+const uint32_t heartPalette[] PROGMEM = {
+  0x000000, 0xFF0000, 0xFF788C
+};
+const uint16_t heartFrames[] PROGMEM = {
+  0, 16
+};
+const byte heartData[] PROGMEM = {
+  0x00, 0x11, 0x10, 0x11, 0x00, 0x01, 0x02, 0xF1, 0x51, 0x00, 0x51, 0x20,
+  0x31, 0x40, 0x11, 0x20, 0x80, 0x11, 0x10, 0x11, 0x10, 0x01, 0x02, 0x31,
+  0x10, 0x51, 0x20, 0x31, 0x40, 0x11, 0xA0,
+};
+const SpriteDef heart PROGMEM = {8, 7, 2, heartPalette, heartFrames, heartData};
@@ -0,0 +1,197 @@
+// Keeping several units in step over a serial link
+// With SYNC_LEADER defined the unit sends a short packet on SYNC_PORT
+// every time it draws an effect frame. A SYNC_FOLLOWER unit draws one
+// frame per packet instead of keeping its own time, after taking the leader's
+// clock, effect, global hue and random seed from it, so every unit draws the
+// same frames without any pixel data going over the link.
+// A follower that hears nothing for SYNC_TIMEOUT runs on its own again.
+//
+// Packet, 12 bytes, multi-byte values little endian:
+//   0     SYNC_START
+//   1-4   leader's millis() for the frame
+//   5     frame counter, followers use it to count lost packets
+//   6     runMode, SYNC_RESTART set when the effect starts over on this frame
+//   7     currentEffect
+//   8     cycleHue
+//   9-10  random seed for the frame
+//   11    sum of bytes 1-10
+//
+// On AVR FastLED.show() turns interrupts off for about 30 us per LED, and
+// the UART keeps only 2 bytes meanwhile, so a packet that arrives during a
+// follower's show() is lost. Linked units therefore only call show() for a
+// new frame, and the leader sends each frame's packet SYNC_MARGIN_MICROS after
+// showing it and starts the next frame only once the packet is out. A follower
+// draws and shows its frame as the packet ends, and is done before the next
+// one starts, as long as it renders no more than SYNC_MARGIN_MICROS slower than
+// the leader. Each frame takes SYNC_PACKET_MICROS longer than it would alone.
+//
+// Every unit needs the same effect lists and canvas size. SYNC_PORT must not
+// be shared with BENCHMARK or MEMORY_REPORT output. tools/synctool.py can watch
+// a link or act as a leader on pseudo-terminals for testing on a host, and
+// tools/host/synctest.py runs a leader and followers of the sketch itself.
+
+#define SYNC_PORT Serial  // use Serial1 on boards that have a second UART
+#define SYNC_BAUD 38400
+#define SYNC_START 0xA5
+#define SYNC_PACKET_SIZE 12
+#define SYNC_PACKET_MICROS (SYNC_PACKET_SIZE * 10 * 1000000UL / SYNC_BAUD) // 3.1 ms
+#define SYNC_MARGIN_MICROS 1000
+#define SYNC_RESTART 0x80
+#define SYNC_TIMEOUT 1000
+
+unsigned long syncMillis = 0; // time of the frame being drawn, the leader's clock on followers
+byte syncFrame = 0;
+
+// Seed the random number generators the effects use
+void syncSeed(uint16_t seed) {
+  random16_set_seed(seed);
+  randomSeed(seed + 1UL); // randomSeed() ignores 0
+  rngSeed(seed);
+}
+
+#if defined(SYNC_LEADER) || defined(SYNC_FOLLOWER)
+// Time for FastLED's beat functions, so they follow the frame clock too
+uint32_t get_millisecond_timer() {
+  return currentMillis;
+}
+#endif
+
+#ifdef SYNC_LEADER
+byte syncPacket[SYNC_PACKET_SIZE];
+boolean syncPending = false;      // syncPacket waits for its frame to be shown
+unsigned long syncShownMicros = 0;
+unsigned long syncSentMicros = 0;
+
+// Seed the frame about to be drawn and make up its packet
+void syncPrepare() {
+  uint16_t seed = random16_get_seed();
+  syncSeed(seed);
+
+  byte *packet = syncPacket;
+  packet[0] = SYNC_START;
+  packet[1] = syncMillis;
+  packet[2] = syncMillis >> 8;
+  packet[3] = syncMillis >> 16;
+  packet[4] = syncMillis >> 24;
+  packet[5] = syncFrame++;
+  packet[6] = runMode | (effectInit ? 0 : SYNC_RESTART);
+  packet[7] = currentEffect;
+  packet[8] = cycleHue;
+  packet[9] = seed;
+  packet[10] = seed >> 8;
+
+  byte sum = 0;
+  for (byte i = 1; i < SYNC_PACKET_SIZE - 1; i++) sum += packet[i];
+  packet[SYNC_PACKET_SIZE - 1] = sum;
+  syncPending = true;
+}
+
+// Send the packet once its frame has been shown and the margin has passed
+void syncSend() {
+  if (!syncPending || micros() - syncShownMicros < SYNC_MARGIN_MICROS) return;
+  SYNC_PORT.write(syncPacket, SYNC_PACKET_SIZE);
+  syncPending = false;
+  syncSentMicros = micros();
+}
+#endif
+
+#ifdef SYNC_FOLLOWER
+byte syncBuffer[SYNC_PACKET_SIZE];
+byte syncLength = 0;
+unsigned long syncHeard = 0; // local time of the last good packet
+uint16_t syncLost = 0;       // packets missed, from gaps in the frame counter
+
+// Take on the leader's state from a complete packet, false if it does not fit this unit
+boolean syncApply() {
+  byte sum = 0;
+  for (byte i = 1; i < SYNC_PACKET_SIZE - 1; i++) sum += syncBuffer[i];
+  if (sum != syncBuffer[SYNC_PACKET_SIZE - 1]) return false;
+
+  byte mode = syncBuffer[6];
+  byte effect = syncBuffer[7];
+  if ((mode & ~SYNC_RESTART) != runMode || effect >= numEffects) return false;
+
+  if (syncHeard != 0 && currentMillis - syncHeard < SYNC_TIMEOUT) syncLost += (byte)(syncBuffer[5] - syncFrame - 1); // not the first packet
+  syncFrame = syncBuffer[5];
+
+  if (effect != currentEffect || (mode & SYNC_RESTART)) {
+    currentEffect = effect;
+    effectInit = false;
+    fadingActive = false;
+  }
+
+  syncMillis = syncBuffer[1] | ((unsigned long)syncBuffer[2] << 8) |
+               ((unsigned long)syncBuffer[3] << 16) | ((unsigned long)syncBuffer[4] << 24);
+  cycleHue = syncBuffer[8];
+  syncSeed(syncBuffer[9] | (syncBuffer[10] << 8));
+  return true;
+}
+
+// Read what has arrived, true once a whole packet has been applied
+boolean syncReceive() {
+  while (SYNC_PORT.available() > 0) {
+    byte data = SYNC_PORT.read();
+    if (syncLength == 0 && data != SYNC_START) continue; // hunt for the start of a packet
+    syncBuffer[syncLength++] = data;
+
+    if (syncLength == SYNC_PACKET_SIZE) {
+      syncLength = 0;
+      if (syncApply()) {
+        syncHeard = currentMillis;
+        return true;
+      }
+    }
+  }
+  return false;
+}
+#endif
+
+// True while a follower is being driven by a leader
+boolean syncFollowing() {
+#ifdef SYNC_FOLLOWER
+  return currentMillis - syncHeard < SYNC_TIMEOUT;
+#else
+  return false;
+#endif
+}
+
+void syncSetup() {
+#if defined(SYNC_LEADER) || defined(SYNC_FOLLOWER)
+  SYNC_PORT.begin(SYNC_BAUD);
+#endif
+}
+
+// Decide whether to draw an effect frame now, and set syncMillis to its time
+boolean syncFrameDue() {
+#ifdef SYNC_FOLLOWER
+  if (syncReceive()) return true;
+  if (syncFollowing()) return false; // wait for the leader
+#endif
+
+#ifdef SYNC_LEADER
+  syncSend();
+  if (syncPending || micros() - syncSentMicros < SYNC_PACKET_MICROS) return false; // let the packet go out first
+#endif
+
+  if (currentMillis - effectMillis <= (unsigned long)effectDelay * FRAME_DIVIDER) return false;
+  syncMillis = currentMillis;
+
+#ifdef SYNC_LEADER
+  syncPrepare();
+#endif
+  return true;
+}
+
+// Show the frame, linked units and sound mode only when a new one was drawn
+// (see above and audio.h)
+void syncShow(boolean frameDrawn) {
+#if !defined(SYNC_LEADER) && !defined(SYNC_FOLLOWER)
+  if (!audioSampling()) frameDrawn = true; // a unit on its own shows every pass
+#endif
+  if (!frameDrawn) return;
+  showFrame();
+  audioShown();
+#ifdef SYNC_LEADER
+  syncShownMicros = micros();
+#endif
+}
@@ -0,0 +1,102 @@
+#!/usr/bin/env python3
+"""Change settings of a board running the SERIAL_CONTROL mode from control.h.
+
+  control.py PORT status
+  control.py PORT effect N | next | brightness N | autocycle 0|1 | palette N | delay MS
+
+Several commands can follow each other, e.g.
+  control.py /dev/ttyUSB0 effect 5 brightness 128 autocycle 0
+
+Prints the status packet the board answers each command with.
+Only needs the standard library.
+"""
+
+import argparse
+import os
+import select
+import sys
+import termios
+import time
+import tty
+
+CONTROL_START = 0xC3
+CONTROL_STATUS_SIZE = 6
+COMMANDS = {'status': (0, False), 'effect': (1, True), 'next': (2, False),
+            'brightness': (3, True), 'autocycle': (4, True), 'palette': (5, True),
+            'delay': (6, True)}
+
+
+def open_port(path):
+    fd = os.open(path, os.O_RDWR | os.O_NOCTTY)
+    tty.setraw(fd)
+    attrs = termios.tcgetattr(fd)
+    attrs[4] = attrs[5] = termios.B115200
+    termios.tcsetattr(fd, termios.TCSANOW, attrs)
+    return fd
+
+
+def packet(command, value):
+    return bytes([CONTROL_START, command, value, (command + value) & 0xFF])
+
+
+def parse(words):
+    """Turn the command line words into (command, value) pairs."""
+    commands = []
+    while words:
+        name = words.pop(0)
+        if name not in COMMANDS:
+            raise ValueError('unknown command %s' % name)
+        command, takes_value = COMMANDS[name]
+        value = 0
+        if takes_value:
+            if not words:
+                raise ValueError('%s needs a value' % name)
+            value = int(words.pop(0), 0)
+            if not 0 <= value <= 255:
+                raise ValueError('%s value must be 0 to 255' % name)
+        commands.append((command, value))
+    return commands
+
+
+def read_status(fd, timeout=1.0):
+    """Return the next status packet as a tuple, or None."""
+    buffer = bytearray()
+    end = time.monotonic() + timeout
+    while time.monotonic() < end:
+        if not select.select([fd], [], [], max(0.0, end - time.monotonic()))[0]:
+            break
+        buffer += os.read(fd, 64)
+        while buffer and buffer[0] != CONTROL_START:
+            del buffer[0]
+        if len(buffer) >= CONTROL_STATUS_SIZE:
+            status = bytes(buffer[:CONTROL_STATUS_SIZE])
+            if sum(status[1:-1]) & 0xFF == status[-1]:
+                return tuple(status[1:-1])
+            del buffer[0]
+    return None
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Send control commands over serial')
+    parser.add_argument('port')
+    parser.add_argument('commands', nargs='+')
+    args = parser.parse_args()
+    try:
+        commands = parse(list(args.commands))
+    except ValueError as error:
+        parser.error(str(error))
+
+    fd = open_port(args.port)
+    time.sleep(2)  # most boards reset when the port opens
+    for command, value in commands:
+        os.write(fd, packet(command, value))
+        status = read_status(fd)
+        if status is None:
+            print('no answer')
+            sys.exit(1)
+        print('effect %d  brightness %d  autocycle %d  runmode %d' % status)
+    os.close(fd)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,128 @@
+#!/usr/bin/env python3
+"""Send test frames to a board running the DMX_RECEIVER mode from dmx.h.
+
+  dmxsend.py HOST [--protocol sacn|artnet] [--width 16 --height 16]
+             [--universe-pixels 170] [--first-universe 1] [--fps 40]
+             [--pattern rainbow|bars|sweep] [--shuffle] [--drop P] [--stale P]
+
+The canvas is sent row by row, left to right, three channels per pixel and
+--universe-pixels pixels per universe, which must match the board.
+--shuffle sends the universes of each frame in random order, --drop leaves
+out packets and --stale resends old packets, to exercise the sequence checks
+and frame assembly. HOST may be 127.0.0.1 with --port for a local receiver.
+
+Only needs the standard library.
+"""
+
+import argparse
+import colorsys
+import random
+import socket
+import struct
+import time
+import uuid
+
+ARTNET_PORT = 6454
+SACN_PORT = 5568
+
+
+def artnet_packet(universe, sequence, data):
+    return (b'Art-Net\0' + struct.pack('<H', 0x5000) + struct.pack('>H', 14) +
+            struct.pack('<BBH', sequence, 0, universe) + struct.pack('>H', len(data)) + data)
+
+
+def sacn_packet(universe, sequence, data, cid, source='dmxsend'):
+    count = len(data) + 1  # property values include the start code
+    dmp = struct.pack('>HBBHHH', 0x7000 | (10 + count), 0x02, 0xA1, 0, 1, count) + b'\0' + data
+    framing = (struct.pack('>HI', 0x7000 | (77 + len(dmp)), 0x00000002) +
+               source.encode()[:63].ljust(64, b'\0') +
+               struct.pack('>BHBBH', 100, 0, sequence, 0, universe) + dmp)
+    root = (struct.pack('>HH', 0x0010, 0) + b'ASC-E1.17\0\0\0' +
+            struct.pack('>HI', 0x7000 | (22 + len(framing)), 0x00000004) + cid + framing)
+    return root
+
+
+def render(pattern, width, height, t):
+    """Return the canvas as bytes, row by row."""
+    pixels = bytearray()
+    for y in range(height):
+        for x in range(width):
+            if pattern == 'bars':
+                on = ((x + int(t * 8)) // 2) % 2
+                color = (255, 0, 0) if on else (0, 0, 255)
+            elif pattern == 'sweep':
+                color = (255, 255, 255) if x == int(t * 8) % width else (0, 0, 0)
+            else:
+                hue = (x + y) / (width + height) + t * 0.2
+                color = tuple(int(c * 255) for c in colorsys.hsv_to_rgb(hue % 1.0, 1.0, 1.0))
+            pixels.extend(color)
+    return bytes(pixels)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Send E1.31 or Art-Net test frames')
+    parser.add_argument('host')
+    parser.add_argument('--protocol', choices=('sacn', 'artnet'), default='sacn')
+    parser.add_argument('--port', type=int, help='UDP port, default for the protocol')
+    parser.add_argument('--width', type=int, default=16)
+    parser.add_argument('--height', type=int, default=16)
+    parser.add_argument('--universe-pixels', type=int, default=170)
+    parser.add_argument('--first-universe', type=int, default=1)
+    parser.add_argument('--fps', type=float, default=40)
+    parser.add_argument('--frames', type=int, default=0, help='stop after this many, 0 runs forever')
+    parser.add_argument('--pattern', choices=('rainbow', 'bars', 'sweep'), default='rainbow')
+    parser.add_argument('--shuffle', action='store_true', help='send universes in random order')
+    parser.add_argument('--drop', type=float, default=0, help='chance of leaving a packet out')
+    parser.add_argument('--stale', type=float, default=0, help='chance of resending an old packet')
+    args = parser.parse_args()
+
+    if not 1 <= args.universe_pixels <= 170:
+        parser.error('--universe-pixels must be 1 to 170')
+    port = args.port or (SACN_PORT if args.protocol == 'sacn' else ARTNET_PORT)
+    channels = args.universe_pixels * 3
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    cid = uuid.uuid4().bytes
+
+    sequence = {}
+    history = []
+    start = time.monotonic()
+    frame = 0
+    sent = dropped = stale = 0
+    try:
+        while args.frames == 0 or frame < args.frames:
+            canvas = render(args.pattern, args.width, args.height, time.monotonic() - start)
+            universes = list(range((len(canvas) + channels - 1) // channels))
+            if args.shuffle:
+                random.shuffle(universes)
+
+            for u in universes:
+                data = canvas[u * channels:(u + 1) * channels]
+                universe = args.first_universe + u
+                last = sequence.get(universe)
+                if args.protocol == 'artnet':
+                    seq = 1 if last is None or last == 255 else last + 1  # 0 means no sequence numbers
+                    packet = artnet_packet(universe, seq, data)
+                else:
+                    seq = 0 if last is None else (last + 1) & 0xFF
+                    packet = sacn_packet(universe, seq, data, cid)
+                sequence[universe] = seq
+
+                if history and random.random() < args.stale:
+                    sock.sendto(random.choice(history), (args.host, port))
+                    stale += 1
+                if random.random() < args.drop:
+                    dropped += 1
+                else:
+                    sock.sendto(packet, (args.host, port))
+                    sent += 1
+                history = (history + [packet])[-8:]
+
+            frame += 1
+            time.sleep(max(0.0, start + frame / args.fps - time.monotonic()))
+    except KeyboardInterrupt:
+        pass
+    print('%d frames, %d packets sent, %d dropped, %d stale' % (frame, sent, dropped, stale))
+
+
+if __name__ == '__main__':
+    main()
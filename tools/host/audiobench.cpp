@@ -0,0 +1,150 @@
+// Audio analysis from a WAV file
+//   audiobench [file.wav]
+// Plays a 16-bit PCM WAV file into audio.h at the microphone's sample rate,
+// as the sampling interrupt would, and runs audioAnalyze() every frame. Prints
+// the bands, the beats and the time one analysis takes on this machine.
+//
+// Without a file it writes build/audiotest.wav, half second tones that should
+// each light their own band and then bass thumps twice a second, and checks
+// the analysis finds them.
+
+#define AUDIO_REACTIVE
+#include "../../FindMyWay.ino"
+
+#define FRAME_MILLIS 20
+#define TEST_RATE 44100
+#define TONE_MILLIS 500
+#define THUMPS 8
+
+struct ToneCheck {
+  unsigned hz;
+  byte band;
+};
+
+// One tone near the middle of bands 1, 3, 5 and 7
+const ToneCheck toneChecks[] = {{300, 1}, {900, 3}, {2100, 5}, {4000, 7}};
+#define TONES (sizeof(toneChecks) / sizeof(toneChecks[0]))
+
+int16_t *wavSamples = NULL;
+uint32_t wavCount = 0;
+uint32_t wavRate = 0;
+
+void put16(FILE *f, uint16_t v) { fputc(v & 255, f); fputc(v >> 8, f); }
+void put32(FILE *f, uint32_t v) { put16(f, v & 0xFFFF); put16(f, v >> 16); }
+
+void writeTestFile(const char *path) {
+  uint32_t toneSamples = TEST_RATE * TONE_MILLIS / 1000;
+  uint32_t count = toneSamples * (TONES + THUMPS);
+  FILE *f = fopen(path, "wb");
+  fwrite("RIFF", 1, 4, f); put32(f, 36 + count * 2); fwrite("WAVE", 1, 4, f);
+  fwrite("fmt ", 1, 4, f); put32(f, 16); put16(f, 1); put16(f, 1);
+  put32(f, TEST_RATE); put32(f, TEST_RATE * 2); put16(f, 2); put16(f, 16);
+  fwrite("data", 1, 4, f); put32(f, count * 2);
+  for (uint32_t n = 0; n < count; n++) {
+    double t = (double)n / TEST_RATE;
+    uint32_t segment = n / toneSamples;
+    double v;
+    if (segment < TONES) {
+      v = 0.5 * sin(2 * M_PI * toneChecks[segment].hz * t);
+    } else {
+      double since = (double)(n % toneSamples) / TEST_RATE; // a 150 Hz thump at each half second
+      v = since < 0.08 ? 0.9 * sin(2 * M_PI * 150 * t) : 0.02 * sin(2 * M_PI * 2000 * t);
+    }
+    put16(f, (uint16_t)(int16_t)(v * 32767));
+  }
+  fclose(f);
+}
+
+uint32_t get32(const byte *p) { return p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24; }
+
+boolean readWav(const char *path) {
+  FILE *f = fopen(path, "rb");
+  if (!f) return false;
+  byte header[12], chunk[8], format[16];
+  if (fread(header, 1, 12, f) != 12 || memcmp(header, "RIFF", 4) || memcmp(header + 8, "WAVE", 4)) return false;
+  int channels = 0;
+  while (fread(chunk, 1, 8, f) == 8) {
+    uint32_t size = get32(chunk + 4);
+    if (!memcmp(chunk, "fmt ", 4)) {
+      if (size < 16 || fread(format, 1, 16, f) != 16) return false;
+      fseek(f, size - 16 + (size & 1), SEEK_CUR);
+      channels = format[2];
+      wavRate = get32(format + 4);
+      if (format[0] != 1 || format[14] != 16 || channels < 1) return false; // 16-bit PCM only
+    } else if (!memcmp(chunk, "data", 4) && channels) {
+      uint32_t frames = size / 2 / channels;
+      int16_t *raw = (int16_t *)malloc(size);
+      frames = fread(raw, 2 * channels, frames, f);
+      wavSamples = (int16_t *)malloc(frames * 2);
+      for (uint32_t i = 0; i < frames; i++) wavSamples[i] = raw[i * channels]; // first channel
+      wavCount = frames;
+      free(raw);
+      break;
+    } else {
+      fseek(f, size + (size & 1), SEEK_CUR);
+    }
+  }
+  fclose(f);
+  return wavCount > 0;
+}
+
+int main(int argc, char **argv) {
+  const char *path = argc > 1 ? argv[1] : "build/audiotest.wav";
+  if (argc <= 1) writeTestFile(path);
+  if (!readWav(path)) {
+    printf("can't read %s, 16-bit PCM WAV files only\n", path);
+    return 1;
+  }
+
+  audioSetup();
+  uint64_t sampleMicros = 0;  // next sample, on the microphone's clock
+  uint32_t bandTotals[TONES + 1][NUM_BANDS] = {};
+  int beats = 0, frames = 0;
+  double analyzeMicros = 0;
+  uint64_t endMicros = (uint64_t)wavCount * 1000000 / wavRate;
+
+  printf("%s: %u samples at %u Hz, FFT_N %d\n", path, wavCount, wavRate, FFT_N);
+  for (currentMillis = 0; currentMillis * 1000ULL < endMicros; currentMillis += FRAME_MILLIS) {
+    // the samples the interrupt would have stored since the last frame
+    for (; sampleMicros < currentMillis * 1000ULL; sampleMicros += AUDIO_SAMPLE_MICROS) {
+      int16_t s = wavSamples[sampleMicros * wavRate / 1000000];
+      audioStore((s >> 8) + 128);
+    }
+
+    unsigned long start = hostWallMicros();
+    audioAnalyze();
+    analyzeMicros += hostWallMicros() - start;
+    frames++;
+
+    if (argc <= 1) {
+      unsigned segment = currentMillis / TONE_MILLIS;
+      if (segment > TONES) segment = TONES;
+      for (byte b = 0; b < NUM_BANDS; b++) bandTotals[segment][b] += audioBands[b];
+    }
+    if (audioBeat) beats++;
+    if (frames % 5 == 0 || audioBeat) {
+      printf("%6lu ms ", currentMillis);
+      for (byte b = 0; b < NUM_BANDS; b++) printf("%4d", audioBands[b]);
+      printf("  level %3d%s\n", audioLevel, audioBeat ? "  beat" : "");
+    }
+  }
+  printf("%d beats, %.2f us per analysis\n", beats, analyzeMicros / frames);
+  if (argc > 1) return 0;
+
+  int failed = 0;
+  for (unsigned t = 0; t < TONES; t++) {
+    byte loudest = 0;
+    for (byte b = 1; b < NUM_BANDS; b++) {
+      if (bandTotals[t][b] > bandTotals[t][loudest]) loudest = b;
+    }
+    if (loudest != toneChecks[t].band) {
+      printf("FAIL: %u Hz came out loudest in band %d, not %d\n", toneChecks[t].hz, loudest, toneChecks[t].band);
+      failed++;
+    }
+  }
+  if (beats < THUMPS - 1 || beats > THUMPS + 1) {
+    printf("FAIL: %d beats for %d thumps\n", beats, THUMPS);
+    failed++;
+  }
+  return failed ? 1 : 0;
+}
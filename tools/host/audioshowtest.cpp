@@ -0,0 +1,73 @@
+// AUDIO_REACTIVE sampling around show() on a simulated clock
+// Runs the sound reactive patterns for RUN_MILLIS of mocked time with the
+// sampling interrupt modelled as on AVR: a sample every AUDIO_SAMPLE_MICROS,
+// none while show() holds interrupts off for SHOW_MICROS, then the one
+// conversion that was pending. Each sample is its own tick count, so a window
+// is contiguous when every sample is one more than the last. Every frame
+// analysed must have been, and no frame may be shown without a new one.
+
+#define AUDIO_REACTIVE
+#include "../../FindMyWay.ino"
+
+#define LOOP_MICROS 500
+#define RUN_MILLIS 10000UL
+#define SHOW_MICROS 7700UL // 256 WS2812B LEDs at 30 us each
+
+unsigned long sampleTick = 0;   // tick of the next sample
+unsigned long framesAnalysed = 0, windowsBroken = 0, showsRepeated = 0;
+unsigned long lastFrameMillis = 0;
+
+unsigned long tickMicros(unsigned long tick) {
+  return tick * AUDIO_SAMPLE_MICROS;
+}
+
+// The interrupt for every tick up to now
+void sampleUntil(unsigned long now) {
+  for (; tickMicros(sampleTick) <= now; sampleTick++) audioStore(sampleTick);
+}
+
+// The window audioAnalyze() just used, then the blackout
+void showBlackout() {
+  if (effectMillis == lastFrameMillis) {
+    showsRepeated++;
+  } else {
+    lastFrameMillis = effectMillis;
+    framesAnalysed++;
+    byte head = audioHead;
+    boolean contiguous = audioFresh == FFT_N;
+    for (byte i = 1; i < FFT_N; i++) {
+      byte previous = audioRing[(head + i - 1) & (FFT_N - 1)];
+      if (audioRing[(head + i) & (FFT_N - 1)] != (byte)(previous + 1)) contiguous = false;
+    }
+    if (!contiguous) windowsBroken++;
+  }
+
+  hostMicros += SHOW_MICROS;
+  unsigned long missed = sampleTick;
+  while (tickMicros(sampleTick) <= hostMicros) sampleTick++;
+  if (sampleTick != missed) audioStore(sampleTick - 1); // the pending conversion
+}
+
+int main() {
+  hostPinLow[BRIGHTNESSBUTTON] = true; // held at power up for sound mode
+  setup();
+  hostPinLow[BRIGHTNESSBUTTON] = false;
+  hostShowHook = showBlackout;
+
+  while (millis() < RUN_MILLIS) {
+    loop();
+    sampleUntil(hostMicros + LOOP_MICROS);
+    hostMicros += LOOP_MICROS;
+  }
+
+  unsigned long frameMillis = RUN_MILLIS / (framesAnalysed ? framesAnalysed : 1);
+  printf("%lu frames analysed, one every %lu ms, %lu broken windows, %lu repeated shows\n",
+         framesAnalysed, frameMillis, windowsBroken, showsRepeated);
+
+  // show plus a fresh window plus the effect's own delay, with a little slack
+  unsigned long budget = (SHOW_MICROS + tickMicros(FFT_N)) / 1000 + effectDelay + 4;
+  boolean ok = runMode == 2 && windowsBroken == 0 && showsRepeated == 0 && framesAnalysed > 0 &&
+               frameMillis <= budget;
+  if (!ok) printf("FAIL\n");
+  return ok ? 0 : 1;
+}
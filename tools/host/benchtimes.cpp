@@ -0,0 +1,78 @@
+// benchmark.h on the host, with the wall clock
+// BENCHMARK only prints over a board's serial port, and a frame takes well
+// under the microsecond micros() counts in here. This times the same pairs,
+// each optimised routine against the reference it replaced, by running each
+// one for BENCH_MICROS and printing nanoseconds per frame and per pixel. The
+// figures are for this machine: the ratio of a pair is what carries over.
+
+#define USER_PROGRAMS
+#include "../../FindMyWay.ino"
+
+#define BENCH_MICROS 100000UL
+
+struct Bench {
+  const char *name;
+  functionList reference; // NULL for a routine timed on its own
+  functionList optimised;
+  void (*prepare)();
+};
+
+void prepareNoise() {
+  noiseInit(30, 6);
+}
+
+void prepareVM() {
+  memcpy_P(vmProgram, vmDefaultProgram, sizeof(vmDefaultProgram));
+}
+
+Bench benches[] = {
+  {"noise", naiveNoise, noiseEngine, prepareNoise},
+  {"life", naiveLife, bitboardLife, lifeSeed},
+  {"threeSine", loopThreeSine, threeSine, NULL},
+  {"slantBars", loopSlantBars, slantBars, NULL},
+  {"candycane", loopCandycane, candycaneSlantbars, NULL},
+  {"checkerboard", loopCheckerboard, checkerboard, NULL},
+  {"slantBars bytecode", slantBars, vmFrame, prepareVM},
+  {"random8 fill", benchRandom8, benchRngFill, NULL},
+  {"glitter", loopGlitter, glitter, NULL},
+  {"confetti", loopConfetti, confetti, NULL},
+  {"snow", loopSnow, snow, NULL},
+  {"line", NULL, benchLine, NULL},
+  {"line AA", NULL, benchLineAA, NULL},
+  {"fill rect", NULL, benchRect, NULL},
+  {"fill circle", NULL, benchCircle, NULL},
+  {"fill polygon", NULL, benchPolygon, NULL},
+  {"project 100 points", NULL, benchProject3D, NULL},
+};
+
+// Nanoseconds per call of func, averaged over BENCH_MICROS
+double benchNanos(functionList func, void (*prepare)()) {
+  if (prepare) prepare();
+  effectInit = false;
+  frameTicks = 256;
+  unsigned long frames = 0;
+  unsigned long start = hostWallMicros();
+  unsigned long elapsed;
+  do {
+    for (byte i = 0; i < 16; i++) func();
+    frames += 16;
+    elapsed = hostWallMicros() - start;
+  } while (elapsed < BENCH_MICROS);
+  return elapsed * 1000.0 / frames;
+}
+
+int main() {
+  setup();
+  printf("canvas %dx%d = %d pixels\n", kMatrixWidth, kMatrixHeight, NUM_LEDS);
+  for (Bench &bench : benches) {
+    double optimised = benchNanos(bench.optimised, bench.prepare);
+    if (bench.reference) {
+      double reference = benchNanos(bench.reference, bench.prepare);
+      printf("%-20s %9.0f ns/frame %6.1f ns/pixel, reference %9.0f ns/frame, %5.2fx\n", bench.name,
+             optimised, optimised / NUM_LEDS, reference, reference / optimised);
+    } else {
+      printf("%-20s %9.0f ns/frame %6.1f ns/pixel\n", bench.name, optimised, optimised / NUM_LEDS);
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,180 @@
+// DEEP_COLOR: effects drawing over the deep buffer, slow fades, blurs and blends
+// Each case runs deepResolve() once per frame as loop() does, with the effect
+// writing leds[] in between, and checks what would have been shown. The blur
+// is checked against the same blur done in floating point. Then prints the
+// RAM the buffers take and the time of each kernel next to its 8-bit version.
+
+#define DEEP_COLOR
+#include "../../FindMyWay.ino"
+
+int failures = 0;
+
+void check(const char *name, boolean ok) {
+  printf("%-48s %s\n", name, ok ? "ok" : "FAIL");
+  if (!ok) failures++;
+}
+
+// A channel at 255 that the effect then draws as 0 for a few frames
+void fullToBlack() {
+  deepLeds[0].r = 0xFF00;
+  deepError[0].r = 0;
+  leds[0].r = 255;
+  deepResolve();
+  for (byte frame = 0; frame < 3; frame++) {
+    leds[0].r = 0;
+    deepResolve();
+  }
+  check("255 drawn over with 0", leds[0].r == 0 && deepLeds[0].r == 0);
+}
+
+// A pixel dithered up to whole + 1, then faded down one step by the effect
+void ditheredOneDown() {
+  deepLeds[0].g = 0x4080; // 64.5, shows 64 and 65 in turn
+  deepError[0].g = 0;
+  leds[0].g = deepShown(deepLeds[0].g, 0);
+  byte shown = 64;
+  for (byte frame = 0; frame < 4 && shown == 64; frame++) {
+    deepResolve();
+    shown = leds[0].g;
+  }
+  leds[0].g = shown - 1;
+  deepResolve();
+  check("dithered 65 faded to 64", shown == 65 && deepLeds[0].g == 64 << 8);
+}
+
+// fadeAll(1) decays by 1/256 a frame, and the dither averages to the deep value
+void slowFade() {
+  fillAll(CRGB(40, 40, 40));
+  deepResolve();
+  uint32_t shownSum = 0, deepSum = 0;
+  for (int frame = 0; frame < 256; frame++) {
+    fadeAll(1);
+    deepResolve();
+    shownSum += leds[0].b;
+    deepSum += deepLeds[0].b;
+  }
+  // 40 * (255/256)^256 is about 14.7
+  check("fadeAll(1) decays exponentially", deepLeds[0].b >= 14 << 8 && deepLeds[0].b < 16 << 8);
+  check("dithered average follows the deep value", abs((int32_t)(shownSum * 256) - (int32_t)deepSum) < 256 * 256);
+}
+
+// A pixel the effect draws before loop() runs fadeTo() must keep what was drawn
+void drawnThenFaded() {
+  fillAll(CRGB::Black);
+  deepResolve();
+  leds[5] = CRGB(200, 100, 50);
+  fadeTo(CRGB::Black, 1);
+  deepResolve();
+  check("drawn pixel survives fadeTo() in the same frame", leds[5].r >= 198 && leds[5].b >= 48);
+}
+
+// blur1d() in floating point, the same steps as deepBlurLine()
+void floatBlurLine(float *line, byte length, byte amount) {
+  float keep = (256 - amount) / 256.0, seep = ((amount >> 1) + 1) / 256.0;
+  float carry = 0;
+  for (byte n = 0; n < length; n++) {
+    float part = line[n] * seep;
+    line[n] = line[n] * keep + carry;
+    if (n) line[n - 1] += part;
+    carry = part;
+  }
+}
+
+// waves2's trail: fadeAll(1) and blurAll(10) each frame after a point was drawn
+void blurredTrail() {
+  static float exact[kMatrixHeight][kMatrixWidth];
+  static CRGB plain[NUM_LEDS + 1];
+  memset(exact, 0, sizeof(exact));
+  fillAll(CRGB::Black);
+  leds[XY(7, 7)].r = 255;
+  exact[7][7] = 255;
+  memcpy(plain, leds, sizeof(plain));
+  deepResolve();
+
+  float deepWorst = 0, plainWorst = 0;
+  for (int frame = 0; frame < 64; frame++) {
+    fadeAll(1);
+    blurAll(10);
+    deepResolve();
+
+    for (uint16_t i = 0; i < NUM_LEDS; i++) plain[i].fadeToBlackBy(1);
+    blur2d(plain, kMatrixWidth, kMatrixHeight, 10);
+
+    for (byte y = 0; y < kMatrixHeight; y++) {
+      for (byte x = 0; x < kMatrixWidth; x++) exact[y][x] *= 255 / 256.0;
+      floatBlurLine(exact[y], kMatrixWidth, 10);
+    }
+    for (byte x = 0; x < kMatrixWidth; x++) {
+      float column[kMatrixHeight];
+      for (byte y = 0; y < kMatrixHeight; y++) column[y] = exact[y][x];
+      floatBlurLine(column, kMatrixHeight, 10);
+      for (byte y = 0; y < kMatrixHeight; y++) exact[y][x] = column[y];
+    }
+
+    for (byte y = 0; y < kMatrixHeight; y++) {
+      for (byte x = 0; x < kMatrixWidth; x++) {
+        deepWorst = max(deepWorst, fabsf(deepLeds[XY(x, y)].r / 256.0f - exact[y][x]));
+        plainWorst = max(plainWorst, fabsf(plain[XY(x, y)].r - exact[y][x]));
+      }
+    }
+  }
+  printf("faded and blurred trail, worst error: deep %.2f, 8-bit %.2f of 255\n", deepWorst, plainWorst);
+  check("blurAll() keeps the fraction of a trail", deepWorst < 2 && deepWorst * 10 < plainWorst);
+}
+
+// An anti-aliased edge blended towards a dim color a little each frame
+void dimBlend() {
+  fillAll(CRGB::Black);
+  deepResolve();
+  CRGB plain = CRGB::Black;
+  for (byte frame = 0; frame < 16; frame++) {
+    blendPixel(0, 0, CRGB(4, 4, 4), 32);
+    deepResolve();
+    nblend(plain, CRGB(4, 4, 4), 32);
+  }
+  // 4 * (1 - (224/256)^16) is about 3.5
+  uint16_t deep = deepLeds[XY(0, 0)].g;
+  printf("dim blend after 16 frames: deep %.2f, 8-bit %d\n", deep / 256.0, plain.g);
+  check("blendPixel() keeps the fraction", deep >= 0x0340 && deep <= 0x0390);
+}
+
+#define TIME_MICROS 20000
+
+// Microseconds per call of kernel, averaged over TIME_MICROS
+double kernelMicros(void (*kernel)()) {
+  unsigned long calls = 0, elapsed;
+  unsigned long start = hostWallMicros();
+  do {
+    kernel();
+    calls++;
+    elapsed = hostWallMicros() - start;
+  } while (elapsed < TIME_MICROS);
+  return (double)elapsed / calls;
+}
+
+void plainFade() {
+  for (uint16_t i = 0; i < NUM_LEDS; i++) leds[i].fadeToBlackBy(1);
+}
+
+void costs() {
+  printf("RAM: deepLeds %u + deepError %u = %u bytes, leds[] is %u\n", (unsigned)sizeof(deepLeds),
+         (unsigned)sizeof(deepError), (unsigned)(sizeof(deepLeds) + sizeof(deepError)), (unsigned)sizeof(leds));
+  for (uint16_t i = 0; i < NUM_LEDS; i++) leds[i] = CHSV(i, 255, 255);
+  deepResolve();
+  printf("fadeAll(1)  %6.2f us, 8-bit %6.2f us\n", kernelMicros([] { fadeAll(1); }), kernelMicros(plainFade));
+  printf("blurAll(10) %6.2f us, 8-bit %6.2f us\n", kernelMicros([] { blurAll(10); }),
+         kernelMicros([] { blur2d(leds, kMatrixWidth, kMatrixHeight, 10); }));
+  printf("deepResolve %6.2f us a frame\n", kernelMicros(deepResolve));
+}
+
+int main() {
+  setup();
+  fullToBlack();
+  ditheredOneDown();
+  slowFade();
+  drawnThenFaded();
+  blurredTrail();
+  dimBlend();
+  costs();
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,50 @@
+// DMX_RECEIVER on localhost UDP, run by dmxtest.py
+// Runs the sketch in real time while dmxtest.py sends it the bars pattern
+// with tools/dmxsend.py. Every frame shown from the network must be whole:
+// each column one color, red or blue, the same in every row. A line on
+// standard input prints the frames and bad frames shown since the last one,
+// and the packets the sequence check dropped; end of input exits.
+
+#define DMX_RECEIVER
+#include <poll.h>
+#include "../../FindMyWay.ino"
+
+int framesShown = 0;
+int framesBad = 0;
+
+void checkFrame() {
+  if (!dmxStreaming) return; // an effect's frame
+  boolean bad = false;
+  for (byte x = 0; x < kMatrixWidth; x++) {
+    CRGB color = leds[XY(x, 0)];
+    if (color != CRGB(255, 0, 0) && color != CRGB(0, 0, 255)) bad = true;
+    for (byte y = 1; y < kMatrixHeight; y++) {
+      if (leds[XY(x, y)] != color) bad = true;
+    }
+  }
+  framesShown++;
+  if (bad) framesBad++;
+}
+
+int main() {
+  hostRealTime = true;
+  setup();
+  hostShowHook = checkFrame;
+  printf("listening, %d universes\n", DMX_UNIVERSES);
+  fflush(stdout);
+
+  pollfd input = {0, POLLIN, 0};
+  while (true) {
+    loop();
+    if (poll(&input, 1, 0) > 0) {
+      char line[16];
+      if (!fgets(line, sizeof(line), stdin)) break;
+      printf("frames %d bad %d dropped %d\n", framesShown, framesBad, dmxDropped);
+      fflush(stdout);
+      framesShown = framesBad = 0;
+      dmxDropped = 0;
+    }
+    usleep(100);
+  }
+  return 0;
+}
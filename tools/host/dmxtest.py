@@ -0,0 +1,53 @@
+#!/usr/bin/env python3
+"""Feed build/dmxreceive from tools/dmxsend.py over localhost UDP.
+
+  dmxtest.py
+
+The receiver is built with DMX_UNIVERSE_PIXELS at 96, so the 16x16 canvas
+takes 3 universes. Sends clean sACN and shuffled Art-Net frames, which must
+all be shown, then sACN with lost, reordered and stale packets, where every
+frame shown must still be whole and the stale packets must be dropped.
+"""
+
+import os
+import subprocess
+import sys
+import time
+
+FRAMES = 60
+
+
+def main():
+    here = os.path.dirname(os.path.realpath(__file__))
+    receiver = subprocess.Popen([os.path.join(here, 'build', 'dmxreceive')], stdin=subprocess.PIPE,
+                                stdout=subprocess.PIPE, text=True)
+    print(receiver.stdout.readline().strip())
+
+    def send(*options):
+        subprocess.run([sys.executable, os.path.join(here, '..', 'dmxsend.py'), '127.0.0.1',
+                        '--universe-pixels', '96', '--pattern', 'bars', '--fps', '100',
+                        '--frames', str(FRAMES)] + list(options), check=True, stdout=subprocess.DEVNULL)
+        time.sleep(0.2)
+        receiver.stdin.write('\n')
+        receiver.stdin.flush()
+        words = receiver.stdout.readline().split()
+        frames, bad, dropped = int(words[1]), int(words[3]), int(words[5])
+        print('%-40s %d frames shown, %d bad, %d dropped' % (' '.join(options) or 'sacn', frames, bad, dropped))
+        return frames, bad, dropped
+
+    failed = False
+    for options in (('--protocol', 'sacn'), ('--protocol', 'artnet', '--shuffle')):
+        frames, bad, _ = send(*options)
+        failed |= frames != FRAMES or bad != 0
+    frames, bad, dropped = send('--protocol', 'sacn', '--shuffle', '--drop', '0.1', '--stale', '0.2')
+    failed |= frames == 0 or frames == FRAMES or bad != 0 or dropped == 0
+
+    receiver.stdin.close()
+    receiver.wait()
+    if failed:
+        print('FAIL')
+        sys.exit(1)
+
+
+if __name__ == '__main__':
+    main()
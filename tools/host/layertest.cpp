@@ -0,0 +1,75 @@
+// OVERLAY_LAYERS over the Christmas effects that use them
+// Runs plasmaMessage and snowFireworks on a simulated clock and looks at
+// every frame shown. Wherever the text mask is set the key layer must show
+// its color; everywhere the spark mask is clear, the snow underneath must be
+// grey, with no rainbow left over from an earlier frame's sparks.
+
+#define OVERLAY_LAYERS
+#include "../../FindMyWay.ino"
+
+#define LOOP_MICROS 1000
+#define RUN_MILLIS 5000UL
+
+int failures = 0;
+unsigned long framesChecked = 0, pixelsWrong = 0, pixelsCovered = 0;
+
+void check(const char *name, boolean ok) {
+  printf("%-48s %s\n", name, ok ? "ok" : "FAIL");
+  if (!ok) failures++;
+}
+
+void checkText() {
+  framesChecked++;
+  CRGB color = layers[0].palette[layers[0].slot];
+  for (byte y = 0; y < kMatrixHeight; y++) {
+    for (byte x = 0; x < kMatrixWidth; x++) {
+      if (!layerGet(0, y * kMatrixWidth + x)) continue;
+      pixelsCovered++;
+      if (leds[XY(x, y)] != color) pixelsWrong++;
+    }
+  }
+}
+
+void checkSparks() {
+  framesChecked++;
+  for (byte y = 0; y < kMatrixHeight; y++) {
+    for (byte x = 0; x < kMatrixWidth; x++) {
+      CRGB pixel = leds[XY(x, y)];
+      if (layerGet(0, y * kMatrixWidth + x)) {
+        pixelsCovered++;
+      } else if (pixel.r != pixel.g || pixel.g != pixel.b) {
+        pixelsWrong++;
+      }
+    }
+  }
+}
+
+void run(void (*effect)(), void (*checkFrame)(), const char *name) {
+  for (currentEffect = 0; effectListTwo[currentEffect] != effect; currentEffect++);
+  effectInit = false;
+  framesChecked = pixelsWrong = pixelsCovered = 0;
+  hostShowHook = NULL;
+  unsigned long end = millis() + RUN_MILLIS;
+  while (millis() < end) {
+    loop();
+    hostMicros += LOOP_MICROS;
+    if (effectInit) hostShowHook = checkFrame; // once the effect has drawn its first frame
+  }
+  hostShowHook = NULL;
+
+  char line[64];
+  snprintf(line, sizeof(line), "%s, %lu shows %lu covered", name, framesChecked, pixelsCovered);
+  check(line, framesChecked > 0 && pixelsCovered > 0 && pixelsWrong == 0);
+}
+
+int main() {
+  hostPinLow[MODEBUTTON] = true; // held at power up for the Christmas patterns
+  setup();
+  hostPinLow[MODEBUTTON] = false;
+  autoCycle = false;
+
+  printf("layer RAM %u bytes for %u layer\n", (unsigned)(sizeof(layers) + sizeof(layerMasks)), LAYER_COUNT);
+  run(plasmaMessage, checkText, "text keyed over plasmaMessage");
+  run(snowFireworks, checkSparks, "no spark left in snowFireworks");
+  return failures ? 1 : 0;
+}
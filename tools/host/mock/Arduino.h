@@ -0,0 +1,219 @@
+// Arduino core for the host build
+// Just enough of the Arduino API for the sketch to compile and run on Linux.
+// Every test is one translation unit, so the globals are defined here.
+//
+// Time comes from hostMicros, which tests move on themselves and delay()
+// advances, or from the wall clock once hostRealTime is set. Pins read HIGH
+// (released) unless hostPinLow[] says otherwise. Serial talks to the file
+// descriptor in hostSerialFd, if any.
+
+#pragma once
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <sched.h>
+#include <sys/ioctl.h>
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define PROGMEM
+#define F(s) s
+#define memcpy_P memcpy
+#define pgm_read_byte(a) (*(const uint8_t *)(a))
+#define pgm_read_word(a) hostRead<uint16_t>(a)
+#define pgm_read_dword(a) hostRead<uint32_t>(a)
+#define pgm_read_ptr(a) hostRead<void *>(a)
+template <class T> T hostRead(const void *address) {
+  T value;
+  memcpy(&value, address, sizeof(value));
+  return value;
+}
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#define A0 14
+
+#define bit(b) (1UL << (b))
+#define bitRead(v, b) (((v) >> (b)) & 1)
+#define bitSet(v, b) ((v) |= bit(b))
+#define bitClear(v, b) ((v) &= ~bit(b))
+#ifndef min
+#define min(a, b) ((a) < (b) ? (a) : (b))
+#define max(a, b) ((a) > (b) ? (a) : (b))
+#endif
+#define constrain(x, l, h) ((x) < (l) ? (l) : ((x) > (h) ? (h) : (x)))
+template <class T> T sq(T x) { return x * x; }
+
+#define noInterrupts()
+#define interrupts()
+
+// Clock
+
+unsigned long hostMicros = 0;
+boolean hostRealTime = false;
+
+unsigned long hostWallMicros() {
+  timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec * 1000000UL + t.tv_nsec / 1000;
+}
+
+unsigned long micros() {
+  return hostRealTime ? hostWallMicros() : hostMicros;
+}
+
+unsigned long millis() {
+  return micros() / 1000;
+}
+
+void delay(unsigned long ms) {
+  if (hostRealTime) usleep(ms * 1000);
+  else hostMicros += ms * 1000;
+}
+
+void delayMicroseconds(unsigned int us) {
+  if (hostRealTime) usleep(us);
+  else hostMicros += us;
+}
+
+void yield() {
+  sched_yield();
+}
+
+// Pins
+
+boolean hostPinLow[64];
+int (*hostAnalogRead)(uint8_t pin) = NULL; // microphone and the like, 0-1023
+
+void pinMode(uint8_t, uint8_t) {}
+void digitalWrite(uint8_t, uint8_t) {}
+
+int digitalRead(uint8_t pin) {
+  return hostPinLow[pin] ? LOW : HIGH;
+}
+
+int analogRead(uint8_t pin) {
+  return hostAnalogRead ? hostAnalogRead(pin) : 512;
+}
+
+// Random numbers, repeatable from run to run
+
+long random(long limit) {
+  return limit ? rand() % limit : 0;
+}
+
+long random(long low, long high) {
+  return low + random(high - low);
+}
+
+void randomSeed(unsigned long seed) {
+  srand(seed);
+}
+
+// Serial
+
+int hostSerialFd = -1;
+
+unsigned long hostSerialRead = 0;    // bytes taken from hostSerialFd so far
+unsigned long hostSerialWritten = 0; // and written to it
+
+class HostSerial {
+ public:
+  void begin(unsigned long) {}
+  void flush() {}
+  operator bool() { return true; }
+
+  int available() {
+    int n = 0;
+    if (hostSerialFd < 0 || ioctl(hostSerialFd, FIONREAD, &n) < 0) return 0;
+    return n;
+  }
+
+  int read() {
+    byte c;
+    if (hostSerialFd < 0 || ::read(hostSerialFd, &c, 1) != 1) return -1;
+    hostSerialRead++;
+    return c;
+  }
+
+  int availableForWrite() { return 63; }
+
+  // Never blocks: what doesn't fit is lost, like a full transmit buffer
+  size_t write(const uint8_t *data, size_t n) {
+    if (hostSerialFd < 0) return n;
+    ssize_t done = ::write(hostSerialFd, data, n);
+    if (done < 0) return 0;
+    hostSerialWritten += done;
+    return done;
+  }
+  size_t write(uint8_t c) { return write(&c, 1); }
+
+  template <class T> void print(T) {}
+  template <class T> void print(T, int) {}
+  template <class T> void println(T) {}
+  template <class T> void println(T, int) {}
+  void println() {}
+};
+
+HostSerial Serial;
+
+#ifdef ESP32
+// FreeRTOS tasks and notifications on std::thread, for DUAL_CORE_PIPELINE
+
+struct HostTask {
+  std::mutex lock;
+  std::condition_variable notified;
+  uint32_t count = 0;
+};
+typedef HostTask *TaskHandle_t;
+
+#define pdTRUE 1
+#define portMAX_DELAY 0xFFFFFFFFUL
+
+thread_local HostTask *hostCurrentTask = NULL;
+
+void xTaskCreatePinnedToCore(void (*task)(void *), const char *, uint32_t, void *params,
+                             int, TaskHandle_t *handle, int) {
+  HostTask *t = new HostTask;
+  *handle = t;
+  std::thread([=] {
+    hostCurrentTask = t;
+    task(params);
+  }).detach();
+}
+
+uint32_t ulTaskNotifyTake(int clear, uint32_t) {
+  HostTask *t = hostCurrentTask;
+  std::unique_lock<std::mutex> held(t->lock);
+  t->notified.wait(held, [t] { return t->count > 0; });
+  uint32_t count = t->count;
+  t->count = clear ? 0 : count - 1;
+  return count;
+}
+
+uint32_t uxTaskGetStackHighWaterMark(TaskHandle_t) {
+  return 0;
+}
+
+void xTaskNotifyGive(TaskHandle_t t) {
+  {
+    std::lock_guard<std::mutex> held(t->lock);
+    t->count++;
+  }
+  t->notified.notify_one();
+}
+#endif
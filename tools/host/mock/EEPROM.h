@@ -0,0 +1,25 @@
+// EEPROM for the host build, erased (0xFF) at start and kept in memory
+// hostEepromWrites counts the cells written, for tests of when writes happen
+
+#pragma once
+
+#include "Arduino.h"
+
+unsigned long hostEepromWrites = 0;
+
+struct EEPROMClass {
+  uint8_t cells[1024];
+
+  EEPROMClass() { memset(cells, 0xFF, sizeof(cells)); }
+  uint8_t read(int address) { return cells[address]; }
+  void write(int address, uint8_t value) {
+    cells[address] = value;
+    hostEepromWrites++;
+  }
+  void update(int address, uint8_t value) {
+    if (cells[address] != value) write(address, value);
+  }
+  uint16_t length() { return sizeof(cells); }
+};
+
+EEPROMClass EEPROM;
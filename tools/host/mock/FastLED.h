@@ -0,0 +1,353 @@
+// FastLED for the host build
+// The colour maths follows FastLED closely enough for effects to look right
+// in a dump; exact values can differ from the real library in the last bit.
+// Palette lookups don't blend between entries. FastLED.show() counts frames
+// and calls hostShowHook, where tests look at or time what would be sent;
+// hostBlends counts nblend() calls for cost estimates.
+
+#pragma once
+
+#include "Arduino.h"
+
+typedef uint8_t fract8;
+typedef uint16_t fract16;
+typedef uint16_t accum88;
+typedef int16_t saccum78;
+
+uint16_t XY(uint8_t x, uint8_t y); // the sketch's layout, for blur2d()
+
+// 8-bit maths
+
+inline uint8_t qadd8(uint8_t a, uint8_t b) { int t = a + b; return t > 255 ? 255 : t; }
+inline uint8_t qsub8(uint8_t a, uint8_t b) { int t = a - b; return t < 0 ? 0 : t; }
+inline uint8_t qmul8(uint8_t a, uint8_t b) { int t = a * b; return t > 255 ? 255 : t; }
+inline uint8_t scale8(uint8_t a, fract8 s) { return (a * (1 + s)) >> 8; }
+inline uint8_t scale8_video(uint8_t a, fract8 s) { return a ? ((a * s) >> 8) + (s ? 1 : 0) : 0; }
+inline uint16_t scale16(uint16_t a, fract16 s) { return ((uint32_t)a * (1 + (uint32_t)s)) >> 16; }
+inline uint16_t scale16by8(uint16_t a, fract8 s) { return (a * (1 + s)) >> 8; }
+inline uint8_t dim8_raw(uint8_t x) { return scale8(x, x); }
+inline uint8_t dim8_video(uint8_t x) { return scale8_video(x, x); }
+inline uint8_t dim8_lin(uint8_t x) { return (x & 0x80) ? scale8(x, x) : (x + 1) / 2; }
+inline uint8_t brighten8_raw(uint8_t x) { return 255 - dim8_raw(255 - x); }
+inline uint8_t lerp8by8(uint8_t a, uint8_t b, fract8 f) { return a + (((int)b - a) * f >> 8); }
+inline uint16_t lerp16by8(uint16_t a, uint16_t b, fract8 f) { return a + (((int32_t)b - a) * f >> 8); }
+inline uint8_t avg8(uint8_t a, uint8_t b) { return (a + b) >> 1; }
+inline uint8_t sqrt16(uint16_t x) { return (uint8_t)sqrt((double)x); }
+
+// Waves
+
+inline uint8_t sin8(uint8_t t) { return (uint8_t)lround(128 + 127 * sin(t * 2 * M_PI / 256)); }
+inline uint8_t cos8(uint8_t t) { return sin8(t + 64); }
+inline int16_t sin16(uint16_t t) { return (int16_t)lround(32767 * sin(t * 2 * M_PI / 65536)); }
+inline int16_t cos16(uint16_t t) { return sin16(t + 16384); }
+inline uint8_t triwave8(uint8_t in) { if (in & 0x80) in = 255 - in; return in << 1; }
+inline uint8_t quadwave8(uint8_t in) { return sin8(in); }
+inline uint8_t cubicwave8(uint8_t in) { return sin8(in); }
+inline uint8_t ease8InOutQuad(uint8_t i) { return i; }
+
+#ifdef USE_GET_MILLISECOND_TIMER
+uint32_t get_millisecond_timer();
+#define HOST_BEAT_MILLIS get_millisecond_timer
+#else
+#define HOST_BEAT_MILLIS millis
+#endif
+
+inline uint16_t beat16(uint16_t bpm, uint32_t = 0) { return HOST_BEAT_MILLIS() * bpm * 280; }
+inline uint8_t beat8(uint16_t bpm, uint32_t = 0) { return beat16(bpm) >> 8; }
+inline uint8_t beatsin8(uint8_t bpm, uint8_t lo = 0, uint8_t hi = 255, uint32_t = 0, uint8_t = 0) {
+  return lo + scale8(sin8(beat8(bpm)), hi - lo);
+}
+inline uint16_t beatsin16(uint16_t bpm, uint16_t lo = 0, uint16_t hi = 65535, uint32_t = 0, uint16_t = 0) {
+  return lo + scale16((uint16_t)(sin16(beat16(bpm)) + 32768), hi - lo);
+}
+
+// Random numbers, FastLED's generator
+
+uint16_t rand16seed = 1337;
+inline uint16_t random16() { rand16seed = rand16seed * 2053 + 13849; return rand16seed; }
+inline uint8_t random8() { random16(); return (uint8_t)rand16seed + (uint8_t)(rand16seed >> 8); }
+inline uint8_t random8(uint8_t lim) { return ((uint16_t)random8() * lim) >> 8; }
+inline uint8_t random8(uint8_t lo, uint8_t hi) { return lo + random8(hi - lo); }
+inline uint16_t random16(uint16_t lim) { return ((uint32_t)random16() * lim) >> 16; }
+inline uint16_t random16(uint16_t lo, uint16_t hi) { return lo + random16(hi - lo); }
+inline void random16_add_entropy(uint16_t e) { rand16seed += e; }
+inline void random16_set_seed(uint16_t s) { rand16seed = s; }
+inline uint16_t random16_get_seed() { return rand16seed; }
+
+// Noise, not Perlin but smooth enough to move
+
+inline uint8_t inoise8(uint16_t x, uint16_t y, uint16_t z) {
+  return (sin8(x >> 7) + sin8(y >> 7) + sin8((x + y + z) >> 8)) / 3;
+}
+inline uint8_t inoise8(uint16_t x, uint16_t y) { return inoise8(x, y, 0); }
+inline uint8_t inoise8_raw(uint16_t x, uint16_t y, uint16_t z) { return inoise8(x, y, z); }
+inline uint16_t inoise16(uint32_t x, uint32_t y, uint32_t z) { return inoise8(x >> 8, y >> 8, z >> 8) << 8; }
+
+// Colours
+
+struct CHSV {
+  uint8_t h, s, v;
+  CHSV() {}
+  CHSV(uint8_t hue, uint8_t sat, uint8_t val) : h(hue), s(sat), v(val) {}
+};
+
+struct CRGB;
+void hsv2rgb_spectrum(const CHSV &hsv, CRGB &rgb);
+
+struct CRGB {
+  union {
+    struct {
+      uint8_t r, g, b;
+    };
+    uint8_t raw[3];
+  };
+
+  enum HTMLColorCode {
+    Black = 0x000000, White = 0xFFFFFF, Red = 0xFF0000, Green = 0x008000, Blue = 0x0000FF,
+    Gray = 0x808080, Grey = 0x808080, DarkBlue = 0x00008B, DarkRed = 0x8B0000,
+    Magenta = 0xFF00FF, Orange = 0xFFA500, Yellow = 0xFFFF00, Cyan = 0x00FFFF,
+    Purple = 0x800080,
+  };
+
+  CRGB() {}
+  CRGB(uint8_t ir, uint8_t ig, uint8_t ib) : r(ir), g(ig), b(ib) {}
+  CRGB(uint32_t c) : r(c >> 16), g(c >> 8), b(c) {}
+  CRGB(int c) : r(c >> 16), g(c >> 8), b(c) {}
+  CRGB(HTMLColorCode c) : CRGB((uint32_t)c) {}
+  CRGB(const CHSV &hsv) { hsv2rgb_spectrum(hsv, *this); }
+
+  uint8_t &operator[](uint8_t i) { return raw[i]; }
+  const uint8_t &operator[](uint8_t i) const { return raw[i]; }
+  CRGB &operator=(const CHSV &hsv) { hsv2rgb_spectrum(hsv, *this); return *this; }
+  CRGB &setRGB(uint8_t nr, uint8_t ng, uint8_t nb) { r = nr; g = ng; b = nb; return *this; }
+  CRGB &setHSV(uint8_t h, uint8_t s, uint8_t v) { return *this = CHSV(h, s, v); }
+
+  CRGB &operator+=(const CRGB &o) { r = qadd8(r, o.r); g = qadd8(g, o.g); b = qadd8(b, o.b); return *this; }
+  CRGB &operator-=(const CRGB &o) { r = qsub8(r, o.r); g = qsub8(g, o.g); b = qsub8(b, o.b); return *this; }
+  CRGB &operator|=(const CRGB &o) { r = max(r, o.r); g = max(g, o.g); b = max(b, o.b); return *this; }
+  CRGB &operator|=(uint8_t d) { r = max(r, d); g = max(g, d); b = max(b, d); return *this; }
+  CRGB &operator*=(uint8_t d) { r = qmul8(r, d); g = qmul8(g, d); b = qmul8(b, d); return *this; }
+  CRGB &operator%=(uint8_t s) { return nscale8_video(s); }
+
+  CRGB &nscale8(uint8_t s) { r = ::scale8(r, s); g = ::scale8(g, s); b = ::scale8(b, s); return *this; }
+  CRGB &nscale8_video(uint8_t s) { r = scale8_video(r, s); g = scale8_video(g, s); b = scale8_video(b, s); return *this; }
+  CRGB &fadeToBlackBy(uint8_t f) { return nscale8(255 - f); }
+  CRGB &fadeLightBy(uint8_t f) { return nscale8_video(255 - f); }
+  CRGB scale8(uint8_t s) const { CRGB o = *this; return o.nscale8(s); }
+
+  uint8_t getLuma() const { return (r * 54 + g * 183 + b * 18) >> 8; }
+  uint8_t getAverageLight() const { return (r + g + b) / 3; }
+  explicit operator bool() const { return r || g || b; }
+  bool operator==(const CRGB &o) const { return r == o.r && g == o.g && b == o.b; }
+  bool operator!=(const CRGB &o) const { return !(*this == o); }
+};
+
+inline CRGB operator+(const CRGB &a, const CRGB &b) { CRGB o = a; return o += b; }
+inline CRGB operator-(const CRGB &a, const CRGB &b) { CRGB o = a; return o -= b; }
+inline CRGB operator*(const CRGB &a, uint8_t s) { CRGB o = a; return o *= s; }
+inline CRGB operator%(const CRGB &a, uint8_t s) { CRGB o = a; return o.nscale8_video(s); }
+
+void hsv2rgb_spectrum(const CHSV &hsv, CRGB &rgb) {
+  // six straight ramps around the wheel, then saturation and value
+  uint16_t h = hsv.h * 6;
+  uint8_t rise = (h & 255), fall = 255 - rise;
+  uint8_t c[3];
+  switch (h >> 8) {
+    case 0: c[0] = 255;  c[1] = rise; c[2] = 0;    break;
+    case 1: c[0] = fall; c[1] = 255;  c[2] = 0;    break;
+    case 2: c[0] = 0;    c[1] = 255;  c[2] = rise; break;
+    case 3: c[0] = 0;    c[1] = fall; c[2] = 255;  break;
+    case 4: c[0] = rise; c[1] = 0;    c[2] = 255;  break;
+    default: c[0] = 255; c[1] = 0;    c[2] = fall; break;
+  }
+  for (byte i = 0; i < 3; i++) {
+    uint8_t white = 255 - hsv.s;
+    rgb.raw[i] = scale8(white + scale8(c[i], hsv.s), hsv.v);
+  }
+}
+
+inline void hsv2rgb_rainbow(const CHSV &hsv, CRGB &rgb) { hsv2rgb_spectrum(hsv, rgb); }
+
+inline CRGB blend(const CRGB &a, const CRGB &b, fract8 f) {
+  return CRGB(lerp8by8(a.r, b.r, f), lerp8by8(a.g, b.g, f), lerp8by8(a.b, b.b, f));
+}
+unsigned long hostBlends = 0;
+inline CRGB &nblend(CRGB &a, const CRGB &b, fract8 f) { hostBlends++; return a = blend(a, b, f); }
+
+
+// LED arrays
+
+inline void fill_solid(CRGB *leds, int n, const CRGB &c) { for (int i = 0; i < n; i++) leds[i] = c; }
+inline void nscale8(CRGB *leds, uint16_t n, uint8_t s) { for (uint16_t i = 0; i < n; i++) leds[i].nscale8(s); }
+inline void fadeToBlackBy(CRGB *leds, uint16_t n, uint8_t f) { nscale8(leds, n, 255 - f); }
+
+// Each pixel keeps 255 - amount of itself and gives amount / 2 to each neighbour
+void blur1d(CRGB *leds, uint16_t n, fract8 amount) {
+  CRGB carry = CRGB::Black;
+  for (uint16_t i = 0; i < n; i++) {
+    CRGB cur = leds[i];
+    CRGB part = cur.scale8(amount >> 1);
+    cur.nscale8(255 - amount);
+    cur += carry;
+    if (i) leds[i - 1] += part;
+    leds[i] = cur;
+    carry = part;
+  }
+}
+
+void blur2d(CRGB *leds, uint8_t width, uint8_t height, fract8 amount) {
+  CRGB line[256];
+  for (uint8_t y = 0; y < height; y++) {
+    for (uint8_t x = 0; x < width; x++) line[x] = leds[XY(x, y)];
+    blur1d(line, width, amount);
+    for (uint8_t x = 0; x < width; x++) leds[XY(x, y)] = line[x];
+  }
+  for (uint8_t x = 0; x < width; x++) {
+    for (uint8_t y = 0; y < height; y++) line[y] = leds[XY(x, y)];
+    blur1d(line, height, amount);
+    for (uint8_t y = 0; y < height; y++) leds[XY(x, y)] = line[y];
+  }
+}
+
+// Palettes
+
+typedef uint32_t TProgmemRGBPalette16[16];
+typedef uint8_t TProgmemRGBGradientPalette_byte;
+typedef const TProgmemRGBGradientPalette_byte *TProgmemRGBGradientPalette_bytes;
+#define DEFINE_GRADIENT_PALETTE(name) \
+  extern const TProgmemRGBGradientPalette_byte name[] PROGMEM; \
+  const TProgmemRGBGradientPalette_byte name[] PROGMEM =
+
+enum TBlendType { NOBLEND = 0, LINEARBLEND = 1 };
+
+struct CRGBPalette16 {
+  CRGB entries[16];
+
+  CRGBPalette16() {}
+  CRGBPalette16(const CRGB &c) { fill_solid(entries, 16, c); }
+  CRGBPalette16(const TProgmemRGBPalette16 &p) { *this = p; }
+  CRGBPalette16(TProgmemRGBGradientPalette_bytes p) { *this = p; }
+
+  CRGBPalette16 &operator=(const TProgmemRGBPalette16 &p) {
+    for (byte i = 0; i < 16; i++) entries[i] = CRGB(p[i]);
+    return *this;
+  }
+
+  // Gradient palettes are index, r, g, b stops ending at index 255
+  CRGBPalette16 &operator=(TProgmemRGBGradientPalette_bytes p) {
+    for (byte i = 0; i < 16; i++) {
+      byte at = i * 17;
+      const uint8_t *stop = p;
+      while (stop[0] < at && stop[0] != 255) stop += 4;
+      if (stop == p || stop[0] == at) {
+        entries[i] = CRGB(stop[1], stop[2], stop[3]);
+      } else {
+        const uint8_t *prev = stop - 4;
+        fract8 f = (at - prev[0]) * 255 / (stop[0] - prev[0]);
+        entries[i] = blend(CRGB(prev[1], prev[2], prev[3]), CRGB(stop[1], stop[2], stop[3]), f);
+      }
+    }
+    return *this;
+  }
+
+  CRGB &operator[](uint8_t i) { return entries[i]; }
+  const CRGB &operator[](uint8_t i) const { return entries[i]; }
+};
+
+inline CRGB ColorFromPalette(const CRGBPalette16 &p, uint8_t index, uint8_t brightness = 255,
+                             TBlendType blending = LINEARBLEND) {
+  CRGB c = p[index >> 4];
+  if (blending == LINEARBLEND && (index & 15)) c = blend(c, p[((index >> 4) + 1) & 15], (index & 15) << 4);
+  if (brightness != 255) c.nscale8_video(brightness);
+  return c;
+}
+
+inline CRGB HeatColor(uint8_t t) {
+  uint8_t ramp = (scale8(t, 191) & 63) << 2;
+  if (t > 170) return CRGB(255, 255, ramp);
+  if (t > 85) return CRGB(255, ramp, 0);
+  return CRGB(ramp, 0, 0);
+}
+
+const TProgmemRGBPalette16 RainbowColors_p = {
+  0xFF0000, 0xD52A00, 0xAB5500, 0xAB7F00, 0xABAB00, 0x56D500, 0x00FF00, 0x00D52A,
+  0x00AB55, 0x0056AA, 0x0000FF, 0x2A00D5, 0x5500AB, 0x7F0081, 0xAB0055, 0xD5002B,
+};
+const TProgmemRGBPalette16 RainbowStripeColors_p = {
+  0xFF0000, 0x000000, 0xAB5500, 0x000000, 0xABAB00, 0x000000, 0x00FF00, 0x000000,
+  0x00AB55, 0x000000, 0x0000FF, 0x000000, 0x5500AB, 0x000000, 0xAB0055, 0x000000,
+};
+const TProgmemRGBPalette16 PartyColors_p = {
+  0x5500AB, 0x84007C, 0xB5004B, 0xE5001B, 0xE81700, 0xB84700, 0xAB7700, 0xABAB00,
+  0xAB5500, 0xDD2200, 0xF2000E, 0xC2003E, 0x8F0071, 0x5F00A1, 0x2F00D0, 0x0007F9,
+};
+const TProgmemRGBPalette16 HeatColors_p = {
+  0x000000, 0x330000, 0x660000, 0x990000, 0xCC0000, 0xFF0000, 0xFF3300, 0xFF6600,
+  0xFF9900, 0xFFCC00, 0xFFFF00, 0xFFFF33, 0xFFFF66, 0xFFFF99, 0xFFFFCC, 0xFFFFFF,
+};
+const TProgmemRGBPalette16 CloudColors_p = {
+  0x0000FF, 0x00008B, 0x00008B, 0x00008B, 0x00008B, 0x00008B, 0x00008B, 0x00008B,
+  0x0000FF, 0x00008B, 0x87CEEB, 0x87CEEB, 0xADD8E6, 0xFFFFFF, 0xADD8E6, 0x87CEEB,
+};
+const TProgmemRGBPalette16 LavaColors_p = {
+  0x000000, 0x800000, 0x000000, 0x800000, 0x8B0000, 0x800000, 0x8B0000, 0x8B0000,
+  0x8B0000, 0xFF0000, 0xFFA500, 0xFFFFFF, 0xFFA500, 0xFF0000, 0x8B0000, 0x000000,
+};
+const TProgmemRGBPalette16 OceanColors_p = {
+  0x191970, 0x00008B, 0x191970, 0x000080, 0x00008B, 0x0000CD, 0x2E8B57, 0x008080,
+  0x5F9EA0, 0x0000FF, 0x008B8B, 0x6495ED, 0x7FFFD4, 0x2E8B57, 0x00FFFF, 0x87CEFA,
+};
+const TProgmemRGBPalette16 ForestColors_p = {
+  0x006400, 0x006400, 0x556B2F, 0x006400, 0x008000, 0x228B22, 0x6B8E23, 0x008000,
+  0x2E8B57, 0x66CDAA, 0x32CD32, 0x9ACD32, 0x90EE90, 0x7CFC00, 0x66CDAA, 0x228B22,
+};
+
+// Controllers
+
+enum EOrder { RGB = 0012, GRB = 0102 };
+template <uint8_t PIN, EOrder ORDER> class WS2812 {};
+template <uint8_t PIN, EOrder ORDER> class WS2811 {};
+template <uint8_t PIN, EOrder ORDER> class NEOPIXEL {};
+
+struct CLEDController {
+  CRGB *leds = NULL;
+  int count = 0;
+
+  CLEDController &setLeds(CRGB *data, int n) { leds = data; count = n; return *this; }
+  CLEDController &setCorrection(uint32_t) { return *this; }
+};
+
+void (*hostShowHook)() = NULL; // called for every FastLED.show()
+
+struct CFastLED {
+  CLEDController controllers[8];
+  int controllerCount = 0;
+  uint8_t brightness = 255;
+  unsigned long shows = 0;
+
+  template <template <uint8_t, EOrder> class CHIPSET, uint8_t PIN, EOrder ORDER>
+  CLEDController &addLeds(CRGB *data, int offset, int count) {
+    return controllers[controllerCount++].setLeds(data + offset, count);
+  }
+
+  template <template <uint8_t, EOrder> class CHIPSET, uint8_t PIN, EOrder ORDER>
+  CLEDController &addLeds(CRGB *data, int count) {
+    return addLeds<CHIPSET, PIN, ORDER>(data, 0, count);
+  }
+
+  void show() {
+    shows++;
+    if (hostShowHook) hostShowHook();
+  }
+
+  CLEDController &operator[](int i) { return controllers[i]; }
+  int count() { return controllerCount; }
+  void setBrightness(uint8_t b) { brightness = b; }
+  uint8_t getBrightness() { return brightness; }
+  void setMaxRefreshRate(uint16_t, bool = false) {}
+  void clear(bool = false) {}
+  void delay(unsigned long ms) { ::delay(ms); }
+  uint16_t getFPS() { return 0; }
+};
+
+CFastLED FastLED;
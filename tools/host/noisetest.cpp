@@ -0,0 +1,80 @@
+// NoiseXY against inoise8 per pixel
+// The engine is an approximation by design, so this checks the parts that
+// must be exact and bounds the rest. Over NOISE_FRAMES frames:
+//   - the coarse grid holds inoise8 at its points for the current z
+//   - every fine row holds inoise8 for a z at most NOISE_PHASES - 1 frames old
+//   - the drawn value, through a grey ramp palette so red is the value, stays
+//     within NOISE_MAX_ERROR of both octaves sampled per pixel, and within
+//     NOISE_MEAN_ERROR on average
+
+#include "../../FindMyWay.ino"
+
+#define NOISE_FRAMES 500
+#define NOISE_MAX_ERROR 12
+#define NOISE_MEAN_ERROR 3.0
+
+int failures = 0;
+
+void check(const char *name, boolean ok) {
+  printf("%-48s %s\n", name, ok ? "ok" : "FAIL");
+  if (!ok) failures++;
+}
+
+byte directCoarse(byte x, byte y, uint16_t z) {
+  return inoise8(x * noiseScale, y * noiseScale, z);
+}
+
+byte directFine(byte x, byte y, uint16_t z) {
+  return inoise8(x * noiseScale * 2 + 0x8000, y * noiseScale * 2, z * 2);
+}
+
+int main() {
+  setup();
+  CRGBPalette16 ramp;
+  for (byte i = 0; i < 16; i++) ramp[i] = CRGB(i * 17, i * 17, i * 17);
+  currentPalette = ramp;
+  frameTicks = 256;
+
+  noiseInit(30, 6);
+  unsigned long gridWrong = 0, fineStale = 0;
+  unsigned long errorSum = 0, pixels = 0;
+  int worst = 0;
+
+  for (int frame = 0; frame < NOISE_FRAMES; frame++) {
+    noiseUpdate();
+    noiseDraw();
+
+    for (byte gy = 0; gy < NOISE_GRID_H; gy++) {
+      for (byte gx = 0; gx < NOISE_GRID_W; gx++) {
+        if (noiseCoarse[gy * NOISE_GRID_W + gx] != directCoarse(gx * NOISE_CELL, gy * NOISE_CELL, noiseZ)) gridWrong++;
+      }
+    }
+
+    for (byte y = 0; y < kMatrixHeight; y++) {
+      boolean found = false;
+      for (byte age = 0; age < NOISE_PHASES && !found; age++) {
+        uint16_t z = noiseZ - age * noiseSpeed;
+        found = true;
+        for (byte x = 0; x < kMatrixWidth; x++) {
+          if (noiseFine[y * kMatrixWidth + x] != directFine(x, y, z)) found = false;
+        }
+      }
+      if (!found) fineStale++;
+
+      for (byte x = 0; x < kMatrixWidth; x++) {
+        byte value = qadd8(qsub8(directCoarse(x, y, noiseZ), 32), directFine(x, y, noiseZ) >> 2);
+        int error = abs((int)leds[XY(x, y)].r - (int)ColorFromPalette(currentPalette, value, 255).r);
+        if (error > worst) worst = error;
+        errorSum += error;
+        pixels++;
+      }
+    }
+  }
+
+  double mean = (double)errorSum / pixels;
+  printf("against inoise8 per pixel: mean error %.2f, worst %d of 255\n", mean, worst);
+  check("coarse grid is inoise8 at its points", gridWrong == 0);
+  check("fine rows at most NOISE_PHASES - 1 frames old", fineStale == 0);
+  check("drawn value close to both octaves per pixel", worst <= NOISE_MAX_ERROR && mean <= NOISE_MEAN_ERROR);
+  return failures ? 1 : 0;
+}
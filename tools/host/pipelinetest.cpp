@@ -0,0 +1,55 @@
+// DUAL_CORE_PIPELINE on two threads
+// loop()'s side renders numbered frames on the main thread while the output
+// task pushes them on its own std::thread. Every frame must reach show()
+// whole, once and in order, and with render and push taking the same time
+// the two must overlap so the run takes well under their sum.
+
+#define ESP32
+#define DUAL_CORE_PIPELINE
+#include "../../FindMyWay.ino"
+
+#define PIPELINE_FRAMES 200
+#define RENDER_MICROS 2000
+#define PUSH_MICROS 2000
+
+volatile int framesShown = 0;
+int framesTorn = 0;
+int framesOutOfOrder = 0;
+
+// A frame's number is in every pixel, read it back from the strip controllers
+void pushFrame() {
+  CRGB *frame = FastLED[0].leds;
+  int number = frame[0].r | (frame[0].g << 8);
+  for (int s = 0; s < FastLED.count(); s++) {
+    for (int i = 0; i < FastLED[s].count; i++) {
+      if (FastLED[s].leds[i] != frame[0]) framesTorn++;
+    }
+  }
+  if (number != framesShown) framesOutOfOrder++;
+  usleep(PUSH_MICROS);
+  framesShown = framesShown + 1;
+}
+
+int main() {
+  hostRealTime = true;
+  setup();
+  hostShowHook = pushFrame;
+
+  unsigned long start = micros();
+  for (int n = 0; n < PIPELINE_FRAMES; n++) {
+    fillAll(CRGB(n, n >> 8, 0x5A));
+    usleep(RENDER_MICROS);
+    showFrame();
+  }
+  while (framesShown < PIPELINE_FRAMES) usleep(100);
+  unsigned long took = micros() - start;
+  unsigned long serial = PIPELINE_FRAMES * (RENDER_MICROS + PUSH_MICROS);
+
+  printf("pipeline: %d frames in %lu us (%lu us one after the other), %d torn, %d out of order\n",
+         framesShown, took, serial, framesTorn, framesOutOfOrder);
+  if (framesTorn || framesOutOfOrder || took > serial * 3 / 4) {
+    printf("FAIL\n");
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,79 @@
+// POWER_SAVE on a simulated clock
+// Runs the sketch for 20 minutes of mocked time with a one minute idle
+// timeout. Awake, each loop() pass takes LOOP_MICROS; asleep, powerSleepHook
+// moves the clock on. A button press halfway through must wake the unit
+// within a few polls without changing the effect, and it must go dark again.
+//
+// The current is added up from a model of an ATmega328 board driving WS2812B
+// LEDs at 5 V, from the time spent awake and asleep and from every frame
+// shown, so the figures are only as good as the constants below.
+
+#define POWER_SAVE
+#define POWER_IDLE_TIMEOUT 60000UL
+#include "../../FindMyWay.ino"
+
+#define LOOP_MICROS 1000
+#define RUN_MILLIS (20 * 60000UL)
+#define PRESS_MILLIS (10 * 60000UL + 3) // between two polls
+#define HOLD_MILLIS 100
+
+#define MCU_ACTIVE_MA 15.0   // ATmega328 at 16 MHz
+#define MCU_SLEEP_MA 0.01    // power-down with the watchdog running
+#define LED_IDLE_MA 0.6      // a WS2812B showing black
+#define LED_CHANNEL_MA 12.0  // one channel fully on
+
+double chargeAwake = 0, chargeAsleep = 0; // mA * ms
+unsigned long millisAwake = 0, millisAsleep = 0;
+double ledMilliamps = NUM_LEDS * LED_IDLE_MA;
+
+boolean pressed = false;
+unsigned long wokeAt = 0;
+
+// Current through the strip for the frame just sent
+void measureFrame() {
+  uint32_t sum = 0;
+  for (int i = 0; i < NUM_LEDS; i++) sum += leds[i].r + leds[i].g + leds[i].b;
+  ledMilliamps = NUM_LEDS * LED_IDLE_MA + sum * LED_CHANNEL_MA / 255 * FastLED.getBrightness() / 255;
+  if (pressed && !wokeAt && FastLED.getBrightness() > 0) wokeAt = millis();
+}
+
+// Press MODEBUTTON at PRESS_MILLIS for HOLD_MILLIS
+void pressButton() {
+  unsigned long now = millis();
+  pressed = now >= PRESS_MILLIS;
+  hostPinLow[MODEBUTTON] = pressed && now - PRESS_MILLIS < HOLD_MILLIS;
+}
+
+void sleepFor(unsigned long ms) {
+  hostMicros += ms * 1000;
+  chargeAsleep += (MCU_SLEEP_MA + ledMilliamps) * ms;
+  millisAsleep += ms;
+  pressButton();
+}
+
+int main() {
+  setup();
+  hostShowHook = measureFrame;
+  powerSleepHook = sleepFor;
+  byte effect = currentEffect;
+
+  while (millis() < RUN_MILLIS) {
+    loop();
+    hostMicros += LOOP_MICROS;
+    chargeAwake += (MCU_ACTIVE_MA + ledMilliamps) * LOOP_MICROS / 1000;
+    millisAwake += LOOP_MICROS / 1000;
+    pressButton();
+  }
+
+  unsigned long latency = wokeAt - PRESS_MILLIS;
+  unsigned long total = millisAwake + millisAsleep;
+  printf("awake %lu ms at %.1f mA, asleep %lu ms at %.2f mA in %lu sleeps\n",
+         millisAwake, chargeAwake / millisAwake, millisAsleep, chargeAsleep / millisAsleep, powerSleeps);
+  printf("average %.2f mA, wake latency %lu ms\n", (chargeAwake + chargeAsleep) / total, latency);
+
+  boolean ok = wokeAt && latency <= 3 * POWER_POLL_MILLIS && currentEffect == effect &&
+               powerState == POWER_ASLEEP && powerSleepMillis == millisAsleep &&
+               millisAsleep > total * 3 / 4;
+  if (!ok) printf("FAIL\n");
+  return ok ? 0 : 1;
+}
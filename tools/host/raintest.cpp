@@ -0,0 +1,44 @@
+// matrixConsole erasing only its drops against a full redraw
+// Runs RAIN_FRAMES frames at a frame clock that wanders between half and
+// three design frames. After each one the canvas must equal a black canvas
+// with every active drop drawn on it, so no trail pixel is left behind.
+
+#include "../../FindMyWay.ino"
+
+#define RAIN_FRAMES 5000
+
+int failures = 0;
+
+void check(const char *name, boolean ok) {
+  printf("%-48s %s\n", name, ok ? "ok" : "FAIL");
+  if (!ok) failures++;
+}
+
+int main() {
+  setup();
+  static CRGB drawn[NUM_LEDS + 1];
+  unsigned long wrong = 0, active = 0;
+
+  effectInit = false;
+  for (int frame = 0; frame < RAIN_FRAMES; frame++) {
+    frameTicks = 128 + (frame * 37) % 640;
+    matrixConsole();
+    memcpy(drawn, leds, sizeof(drawn));
+
+    fillAll(CRGB::Black);
+    for (byte col = 0; col < RAIN_COLUMNS; col++) {
+      for (byte d = 0; d < DROPS_PER_COLUMN; d++) {
+        // a drop spawned this frame is still at y == 0 and first drawn next frame
+        if (gDrops[col][d].y > 0) gDrops[col][d].Draw(col);
+      }
+    }
+    if (memcmp(drawn, leds, NUM_LEDS * sizeof(CRGB)) != 0) wrong++;
+    active += rainActiveDrops;
+    memcpy(leds, drawn, sizeof(drawn));
+  }
+
+  printf("%.1f drops on average, %u bytes of effectScratch\n", (double)active / RAIN_FRAMES,
+         (unsigned)(sizeof(Drop) * RAIN_COLUMNS * DROPS_PER_COLUMN));
+  check("every frame matches a full redraw", wrong == 0 && active > 0);
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,66 @@
+// render3d.h effects against the AVR frame budget
+// Runs starfield and tunnelFlight for RENDER_FRAMES frames each, timing them
+// on the host and counting the anti-aliased pixels they blend. From those
+// counts and the most projections, lines and divisions a frame of each can
+// do, it estimates the worst frame on a 16 MHz ATmega328 and fails when that
+// takes more than AVR_SHARE of the effect's 10 ms effectDelay, leaving the
+// rest for the estimate being off.
+//
+// The cycle costs below are estimates for avr-gcc -Os code (libgcc's 32-bit
+// division, FastLED's AVR scale8), not measurements; BENCHMARK on a board
+// gives the real figure.
+
+#include "../../FindMyWay.ino"
+
+#define RENDER_FRAMES 2000
+#define AVR_MHZ 16
+#define AVR_SHARE 0.8
+
+#define CYCLES_FILL (NUM_LEDS * 8)   // fillAll()
+#define CYCLES_PROJECT 300           // render3DProject(), two 32-bit multiplies and shifts
+#define CYCLES_LINE 900              // drawLineAA() setup, one 32-bit division
+#define CYCLES_DIVIDE 700            // render3DFade() and others, a 32-bit division
+#define CYCLES_BLEND 140             // blendPixel(), bounds, XY() and nblend()
+#define CYCLES_ITEM 150              // per star or ring: hashing, palette lookups, loop
+
+struct Work {
+  const char *name;
+  void (*effect)();
+  unsigned long projections; // at most, per frame
+  unsigned long lines;
+  unsigned long divides;
+  unsigned long items;
+};
+
+Work work[] = {
+  {"starfield", starfield, 2 * STARFIELD_STARS, STARFIELD_STARS, 0, STARFIELD_STARS},
+  {"tunnelFlight", tunnelFlight, TUNNEL_RINGS * TUNNEL_SIDES, TUNNEL_RINGS * TUNNEL_SIDES * 3 / 2,
+   TUNNEL_RINGS, TUNNEL_RINGS},
+};
+
+int main() {
+  setup();
+  int failures = 0;
+  for (Work &w : work) {
+    effectInit = false;
+    frameTicks = 256;
+    unsigned long mostBlends = 0;
+    unsigned long start = hostWallMicros();
+    for (int frame = 0; frame < RENDER_FRAMES; frame++) {
+      hostBlends = 0;
+      w.effect();
+      if (hostBlends > mostBlends) mostBlends = hostBlends;
+    }
+    double hostMicrosPerFrame = (double)(hostWallMicros() - start) / RENDER_FRAMES;
+
+    unsigned long cycles = CYCLES_FILL + w.projections * CYCLES_PROJECT + w.lines * CYCLES_LINE +
+                           w.divides * CYCLES_DIVIDE + w.items * CYCLES_ITEM + mostBlends * CYCLES_BLEND;
+    double avrMillis = cycles / (AVR_MHZ * 1000.0);
+    boolean ok = avrMillis < effectDelay * AVR_SHARE;
+    printf("%-13s %3lu points %3lu lines %4lu blends at most, host %.1f us, AVR about %.1f ms of %d %s\n",
+           w.name, w.projections, w.lines, mostBlends, hostMicrosPerFrame, avrMillis, effectDelay,
+           ok ? "ok" : "FAIL");
+    if (!ok) failures++;
+  }
+  return failures ? 1 : 0;
+}
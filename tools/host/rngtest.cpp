@@ -0,0 +1,85 @@
+// Golden frames for the effects that draw with rng.h
+// Seeds rngSeed() with a pinned seed, runs glitter, confetti and snow for
+// RNG_FRAMES frames each at the design frame rate and hashes every frame.
+// The hashes must match the stored ones, so a change to the generator, its
+// seeding or the way these effects draw from it shows up here. After an
+// intended change run with --update and paste the printed table in.
+//
+// The colors come from the host build's FastLED stand-ins, so the hashes
+// only hold for this build, not for frames on a board.
+
+#include "../../FindMyWay.ino"
+
+#define RNG_SEED 0x5EED
+#define RNG_FRAMES 200
+
+struct Golden {
+  const char *name;
+  void (*effect)();
+  uint32_t hash;
+};
+
+Golden goldens[] = {
+  {"rng", NULL, 0x715574cb},
+  {"glitter", glitter, 0x41afb56d},
+  {"confetti", confetti, 0xc1ae75cf},
+  {"snow", snow, 0xc3a09a5c},
+};
+
+uint32_t hashBytes(uint32_t hash, const byte *data, uint16_t count) {
+  while (count--) hash = (hash ^ *data++) * 16777619u;
+  return hash;
+}
+
+// The generator on its own: every helper in turn after rngSeed()
+uint32_t runGenerator() {
+  rngSeed(RNG_SEED);
+  uint32_t hash = 2166136261u;
+  for (uint16_t i = 0; i < 1000; i++) {
+    byte values[5] = {rng8(), rngBelow8(i), rngRange8(10, 20), (byte)rng16(), (byte)(rngBelow16(i * 61) >> 4)};
+    hash = hashBytes(hash, values, sizeof(values));
+  }
+  byte filled[37];
+  rngFill(filled, sizeof(filled));
+  return hashBytes(hash, filled, sizeof(filled));
+}
+
+uint32_t runEffect(void (*effect)()) {
+  // let the effect set itself up, then start every run from the same state
+  effectInit = false;
+  effect();
+  fillAll(CRGB::Black);
+  currentPalette = RainbowColors_p;
+  cycleHue = 0;
+  frameTicks = 256;
+  rngSeed(RNG_SEED);
+
+  uint32_t hash = 2166136261u;
+  for (uint16_t frame = 0; frame < RNG_FRAMES; frame++) {
+    effect();
+    hash = hashBytes(hash, (const byte *)leds, NUM_LEDS * sizeof(CRGB));
+    cycleHue++;
+  }
+  return hash;
+}
+
+int main(int argc, char **argv) {
+  boolean update = argc > 1 && strcmp(argv[1], "--update") == 0;
+  setup();
+
+  int failures = 0;
+  for (Golden &golden : goldens) {
+    uint32_t hash = golden.effect ? runEffect(golden.effect) : runGenerator();
+    if (update) {
+      printf("  {\"%s\", %s, 0x%08x},\n", golden.name, golden.effect ? golden.name : "NULL", hash);
+      continue;
+    }
+    if (hash == golden.hash) {
+      printf("%-10s %08x ok\n", golden.name, hash);
+    } else {
+      printf("%-10s %08x FAIL, stored %08x\n", golden.name, hash, golden.hash);
+      failures++;
+    }
+  }
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,73 @@
+// shade() against plain x/y loops through XY()
+// Shades a pattern that is different at every pixel and compares it with the
+// same pattern drawn pixel by pixel through XY(): every visible pixel must
+// match, and the hidden pixel must not be written. Then runs slantBars,
+// candycaneSlantbars and checkerboard next to their loops from benchmark.h
+// for SHADE_FRAMES frames each. Built once for the single panel and once with
+// SHADE_TILED for 2x2 panels in every rotation, with and without serpentine
+// rows, which takes each of shade()'s paths.
+
+#ifdef SHADE_TILED
+#define TILES_X 2
+#define TILES_Y 2
+#define TILE_MAP {3, ROTATE_90, false}, {2, ROTATE_180, true}, {0, ROTATE_270, true}, {1, ROTATE_0, true},
+#endif
+#include "../../FindMyWay.ino"
+
+#define SHADE_FRAMES 64
+
+int failures = 0;
+
+void check(const char *name, boolean ok) {
+  printf("%-48s %s\n", name, ok ? "ok" : "FAIL");
+  if (!ok) failures++;
+}
+
+CRGB expected[NUM_LEDS + 1];
+
+// A color made from x and y, so any pixel in the wrong place shows
+CRGB coordinate(byte x, byte y) {
+  return CRGB(x, y, x * 7 + y * 13 + 1);
+}
+
+void shadeCoordinates() {
+  const CRGB unset(1, 2, 3);
+  for (uint16_t i = 0; i <= NUM_LEDS; i++) leds[i] = expected[i] = unset;
+  for (byte y = 0; y < kMatrixHeight; y++) {
+    for (byte x = 0; x < kMatrixWidth; x++) expected[XY(x, y)] = coordinate(x, y);
+  }
+
+  byte rowSetups = 0;
+  shade([&](byte) { rowSetups++; }, [&](byte x, byte y) { return coordinate(x, y); });
+
+  char name[64];
+  snprintf(name, sizeof(name), "every pixel of %dx%d, %s", kMatrixWidth, kMatrixHeight,
+           xyRowsContiguous() ? "one panel" : "tiled");
+  check(name, memcmp(leds, expected, sizeof(expected)) == 0 && rowSetups == kMatrixHeight);
+}
+
+// The effect and its loop start from the same phase and must agree every frame
+void compareEffect(const char *name, void (*effect)(), void (*loop)(), byte loopStart) {
+  effectInit = false;
+  frameTicks = 256;
+  loopPhase = loopStart;
+  unsigned long mismatches = 0;
+  for (int frame = 0; frame < SHADE_FRAMES; frame++) {
+    effect();
+    memcpy(expected, leds, sizeof(expected));
+    loop();
+    if (memcmp(leds, expected, sizeof(expected)) != 0) mismatches++;
+    cycleHue += 3;
+  }
+  check(name, mismatches == 0);
+}
+
+int main() {
+  setup();
+  shadeCoordinates();
+  // the effects draw, then step their phase; the loops step first
+  compareEffect("slantBars matches its loop", slantBars, loopSlantBars, 4);
+  compareEffect("candycaneSlantbars matches its loop", candycaneSlantbars, loopCandycane, 4);
+  compareEffect("checkerboard matches its loop", checkerboard, loopCheckerboard, 0);
+  return failures ? 1 : 0;
+}
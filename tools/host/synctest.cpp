@@ -0,0 +1,87 @@
+// One unit of a sync link, run by synctest.py
+//   synclead PORT    leader, moves to the next effect every second
+//   syncfollow PORT  follower
+// Talks on the serial device PORT. Time is simulated and only moves on when
+// synctest.py says so, on standard input:
+//   run T N   wait until N bytes in all have come in on PORT, then run loop()
+//             until micros() reaches T, each pass taking LOOP_MICROS
+//   end       print the packets lost and exit
+// and answers on standard output with a line for every frame shown (its time,
+// the effect and a hash of the pixels), one for the time show() took, and
+//   at T W    the time reached and the bytes written to PORT in all
+// show() takes as long as it does on AVR, so synctest.py can tell which bytes
+// would have come in while interrupts were off.
+
+#include <termios.h>
+#include "../../FindMyWay.ino"
+
+#define LOOP_MICROS 100
+#define SHOW_MICROS_PER_LED 30
+
+void avrShow() {
+  unsigned long start = micros();
+  hostMicros += NUM_LEDS * SHOW_MICROS_PER_LED;
+  printf("show %lu %lu\n", start, micros());
+
+  uint32_t hash = 2166136261u;
+  for (int i = 0; i < NUM_LEDS; i++) {
+    for (byte c = 0; c < 3; c++) hash = (hash ^ leds[i][c]) * 16777619u;
+  }
+  printf("frame %lu %d %08x\n", syncMillis, currentEffect, hash);
+}
+
+// Wait for the bytes synctest.py has passed on to come through the terminal
+void receiveUpTo(unsigned long total) {
+  for (int tries = 0; hostSerialRead + Serial.available() < total; tries++) {
+    if (tries == 10000) {
+      fprintf(stderr, "waited a second for %lu bytes\n", total - hostSerialRead);
+      exit(1);
+    }
+    usleep(100);
+  }
+}
+
+int main(int argc, char **argv) {
+  if (argc != 2) {
+    fprintf(stderr, "usage: %s PORT\n", argv[0]);
+    return 2;
+  }
+  hostSerialFd = open(argv[1], O_RDWR | O_NOCTTY | O_NONBLOCK);
+  if (hostSerialFd < 0) {
+    perror(argv[1]);
+    return 1;
+  }
+  termios attrs;
+  tcgetattr(hostSerialFd, &attrs);
+  cfmakeraw(&attrs);
+  tcsetattr(hostSerialFd, TCSANOW, &attrs);
+
+  setup();
+  hostShowHook = avrShow;
+
+  char command[64];
+  while (fgets(command, sizeof(command), stdin)) {
+    unsigned long until, total;
+    if (sscanf(command, "run %lu %lu", &until, &total) == 2) {
+      receiveUpTo(total);
+      while ((long)(micros() - until) < 0) {
+        loop();
+#ifdef SYNC_LEADER
+        if (millis() - cycleMillis > 1000) cyclePattern();
+#endif
+        hostMicros += LOOP_MICROS;
+      }
+      printf("at %lu %lu\n", micros(), hostSerialWritten);
+      fflush(stdout);
+    } else if (strncmp(command, "end", 3) == 0) {
+      break;
+    }
+  }
+
+#ifdef SYNC_FOLLOWER
+  printf("lost %d\n", syncLost);
+#else
+  printf("lost 0\n");
+#endif
+  return 0;
+}
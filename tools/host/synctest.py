@@ -0,0 +1,144 @@
+#!/usr/bin/env python3
+"""Run a sync leader and followers of the sketch on pseudo-terminals.
+
+  synctest.py [--followers N] [--seconds S] [--baud B]
+
+Starts build/synclead and N build/syncfollow, each on its own pseudo-terminal,
+and carries the leader's bytes to every follower one at a time at the baud
+rate, as a wire would. Time is simulated: every unit runs in small steps of
+the same clock (see synctest.cpp), so the result doesn't depend on how busy
+the host is. A byte that reaches a follower while it is in show() is lost,
+beyond the 2 an AVR UART holds with interrupts off.
+
+Afterwards every frame a follower showed must match the leader's frame for
+the same time, nearly every leader frame must have been shown, and no byte
+or packet may be lost.
+"""
+
+import argparse
+import os
+import pty
+import select
+import subprocess
+import sys
+import tty
+
+UART_HOLDS = 2
+
+
+class Unit:
+    def __init__(self, program):
+        self.master, slave = pty.openpty()
+        tty.setraw(self.master)
+        tty.setraw(slave)
+        self.process = subprocess.Popen([program, os.ttyname(slave)], stdin=subprocess.PIPE,
+                                        stdout=subprocess.PIPE, text=True)
+        os.close(slave)
+        self.clock = 0
+        self.written = 0    # bytes the unit wrote
+        self.taken = 0      # of those, read from the terminal
+        self.given = 0      # bytes passed to the unit
+        self.show = (0, 0)  # last show(), interrupts off
+        self.held = 0       # bytes the UART took in during it
+        self.dropped = 0
+        self.frames = {}
+
+    def command(self, line):
+        self.process.stdin.write(line + '\n')
+        self.process.stdin.flush()
+
+    def run(self, until):
+        self.command('run %d %d' % (until, self.given))
+        while True:
+            words = self.process.stdout.readline().split()
+            if not words:
+                sys.exit('unit stopped')
+            if words[0] == 'frame':
+                self.frames[int(words[1])] = (int(words[2]), words[3])
+            elif words[0] == 'show':
+                self.show = (int(words[1]), int(words[2]))
+                self.held = 0
+            elif words[0] == 'at':
+                self.clock, self.written = int(words[1]), int(words[2])
+                return
+
+    def take(self):
+        """The bytes the unit wrote since the last call."""
+        data = bytearray()
+        while self.taken + len(data) < self.written:
+            if not select.select([self.master], [], [], 1.0)[0]:
+                sys.exit('unit wrote %d bytes, only %d came through'
+                         % (self.written, self.taken + len(data)))
+            data += os.read(self.master, self.written - self.taken - len(data))
+        self.taken += len(data)
+        return data
+
+    def give(self, arrival, byte):
+        start, end = self.show
+        if start < arrival <= end:
+            self.held += 1
+            if self.held > UART_HOLDS:
+                self.dropped += 1
+                return
+        os.write(self.master, bytes([byte]))
+        self.given += 1
+
+    def finish(self):
+        self.command('end')
+        lost = int(self.process.communicate()[0].split()[-1])
+        os.close(self.master)
+        return lost
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('--followers', type=int, default=2)
+    parser.add_argument('--seconds', type=int, default=3)
+    parser.add_argument('--baud', type=int, default=38400)
+    args = parser.parse_args()
+    build = os.path.join(os.path.dirname(os.path.realpath(__file__)), 'build')
+
+    followers = [Unit(os.path.join(build, 'syncfollow')) for _ in range(args.followers)]
+    leader = Unit(os.path.join(build, 'synclead'))
+
+    byte_micros = 10 * 1000000 // args.baud
+    wire = []       # (arrival time, byte) of everything the leader sent
+    wire_free = 0   # time the last byte is through
+    delivered = [0] * len(followers)
+    for now in range(byte_micros, args.seconds * 1000000, byte_micros):
+        if leader.clock < now:
+            leader.run(now)
+            for byte in leader.take():
+                wire_free = max(wire_free, leader.clock) + byte_micros
+                wire.append((wire_free, byte))
+
+        for n, follower in enumerate(followers):
+            # bytes that arrived up to the follower's own time, then run it on
+            while delivered[n] < len(wire) and wire[delivered[n]][0] <= follower.clock:
+                follower.give(*wire[delivered[n]])
+                delivered[n] += 1
+            if follower.clock < now:
+                follower.run(now)
+
+    leader.finish()
+    lead_frames = leader.frames
+    failed = False
+    for n, follower in enumerate(followers):
+        lost = follower.finish()
+        shown = follower.frames
+        following = [t for t in shown if t in lead_frames]
+        first = min(following) if following else None
+        expected = [t for t in lead_frames if first is not None and t >= first]
+        wrong = [t for t in following if shown[t] != lead_frames[t]]
+        print('follower %d: %d of %d leader frames, %d different, lost %d packets %d bytes'
+              % (n, len(following), len(expected), len(wrong), lost, follower.dropped))
+        if not following or wrong or lost or follower.dropped or len(following) < len(expected) * 9 // 10:
+            failed = True
+    print('leader: %d frames' % len(lead_frames))
+    if failed:
+        print('FAIL')
+        sys.exit(1)
+
+
+if __name__ == '__main__':
+    main()
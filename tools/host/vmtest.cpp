@@ -0,0 +1,107 @@
+// USER_PROGRAMS: the built-in bytecode against compiled code, and uploads
+// Runs userProgram with the built-in slantBars image next to the compiled
+// slantBars for VM_FRAMES frames at one and at two design frames per frame,
+// and every frame must match. (Below one the bytecode's T only counts whole
+// design frames, so the two drift apart by design.)
+//
+// Then uploads a changed image through vmReceiveByte(): nothing may be written
+// to EEPROM while it arrives, the new program must run at once, loop() must
+// write at most VM_SAVE_BYTES a pass, an upload during the save must be
+// ignored, and in the end EEPROM must hold the image for vmLoad().
+
+#define USER_PROGRAMS
+#include "../../FindMyWay.ino"
+
+#define VM_FRAMES 300
+#define LOOP_MICROS 1000
+
+int failures = 0;
+
+void check(const char *name, boolean ok) {
+  printf("%-48s %s\n", name, ok ? "ok" : "FAIL");
+  if (!ok) failures++;
+}
+
+CRGB compiled[NUM_LEDS + 1];
+
+void compareSlantBars() {
+  effectInit = false;
+  unsigned long mismatches = 0;
+  for (int frame = 0; frame < 2 * VM_FRAMES; frame++) {
+    frameTicks = frame < VM_FRAMES ? 256 : 512;
+    slantBars();
+    memcpy(compiled, leds, sizeof(compiled));
+    userProgram();
+    if (memcmp(leds, compiled, NUM_LEDS * sizeof(CRGB)) != 0) mismatches++;
+    cycleHue += 5;
+  }
+  check("bytecode slantBars matches the compiled one", mismatches == 0);
+}
+
+void sendUpload(const byte *image, byte length) {
+  byte sum = length;
+  vmReceiveByte(VM_LOAD_START);
+  vmReceiveByte(length);
+  for (byte i = 0; i < length; i++) {
+    vmReceiveByte(image[i]);
+    sum += image[i];
+  }
+  vmReceiveByte(sum);
+}
+
+void upload() {
+  byte image[sizeof(vmDefaultProgram)];
+  memcpy_P(image, vmDefaultProgram, sizeof(image));
+  image[0] = 7;  // effectDelay
+  image[8] = 8;  // r0 = -8t
+  byte length = sizeof(image);
+
+  currentEffect = 0;
+  effectInit = false;
+  unsigned long writes = hostEepromWrites;
+  sendUpload(image, length);
+  check("nothing written while the upload arrives", hostEepromWrites == writes);
+
+  hostMicros += 100000;
+  loop(); // one pass with a frame due: the new program starts from RAM
+  check("uploaded program runs at once", effectListOne[currentEffect] == userProgram &&
+        effectDelay == 7 && memcmp(vmProgram, image, length) == 0);
+
+  byte other[sizeof(image)];
+  memcpy(other, image, sizeof(other));
+  other[0] = 9;
+  sendUpload(other, length);
+
+  unsigned long passes = 0, mostWrites = 0;
+  writes = hostEepromWrites;
+  while (vmSaveLeft > 0 && passes < 1000) {
+    unsigned long before = hostEepromWrites;
+    loop();
+    hostMicros += LOOP_MICROS;
+    if (hostEepromWrites - before > mostWrites) mostWrites = hostEepromWrites - before;
+    passes++;
+  }
+  printf("saved %lu bytes in %lu passes, at most %lu a pass\n", hostEepromWrites - writes, passes, mostWrites);
+  check("at most VM_SAVE_BYTES written a pass", vmSaveLeft == 0 && mostWrites <= VM_SAVE_BYTES);
+
+  byte sum = length;
+  boolean stored = EEPROM.read(VM_EEPROM_ADDR) == length;
+  for (byte i = 0; i < length; i++) {
+    stored = stored && EEPROM.read(VM_EEPROM_ADDR + 1 + i) == image[i];
+    sum += image[i];
+  }
+  stored = stored && EEPROM.read(VM_EEPROM_ADDR + 1 + length) == sum;
+  check("EEPROM holds the first upload, not the second", stored);
+
+  memset(vmProgram, 0, VM_PROGRAM_SIZE);
+  vmLoad();
+  check("vmLoad() takes it back from EEPROM", memcmp(vmProgram, image, length) == 0);
+}
+
+int main() {
+  setup();
+  autoCycle = false;
+  compareSlantBars();
+  upload();
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,151 @@
+#!/usr/bin/env python3
+"""Convert a PNG sprite sheet into RLE sprite data for SpriteXY.h.
+
+Frames are laid out left to right in the sheet, each frame_width pixels wide
+and as tall as the sheet. Pixels with alpha below 128 are transparent
+(palette index 0), every other distinct colour, black included, gets its
+own palette entry, up to 15 colours per sprite.
+
+Each frame is stored as runs in row order, one byte per run:
+high nibble = run length - 1 (1-16 pixels), low nibble = palette index.
+
+Usage: png2sprite.py sheet.png name frame_width > sprite.h
+
+Only needs the standard library; reads 8-bit non-interlaced PNGs
+(RGB, RGBA or indexed colour).
+"""
+
+import struct
+import sys
+import zlib
+
+
+def read_png(path):
+    with open(path, 'rb') as f:
+        data = f.read()
+    if data[:8] != b'\x89PNG\r\n\x1a\n':
+        sys.exit('%s: not a PNG file' % path)
+
+    pos = 8
+    idat = b''
+    palette = []
+    alpha = []
+    while pos < len(data):
+        length, kind = struct.unpack('>I4s', data[pos:pos + 8])
+        body = data[pos + 8:pos + 8 + length]
+        pos += 12 + length
+        if kind == b'IHDR':
+            width, height, depth, color_type, _, _, interlace = struct.unpack('>IIBBBBB', body)
+            if depth != 8 or interlace != 0 or color_type not in (2, 3, 6):
+                sys.exit('%s: only 8-bit non-interlaced RGB, RGBA or indexed PNGs are supported' % path)
+        elif kind == b'PLTE':
+            palette = [tuple(body[i:i + 3]) for i in range(0, len(body), 3)]
+        elif kind == b'tRNS':
+            alpha = list(body)
+        elif kind == b'IDAT':
+            idat += body
+        elif kind == b'IEND':
+            break
+
+    channels = {2: 3, 3: 1, 6: 4}[color_type]
+    stride = width * channels
+    raw = zlib.decompress(idat)
+    rows = []
+    prev = bytearray(stride)
+    for y in range(height):
+        start = y * (stride + 1)
+        filter_type = raw[start]
+        line = bytearray(raw[start + 1:start + 1 + stride])
+        for i in range(stride):
+            a = line[i - channels] if i >= channels else 0
+            b = prev[i]
+            c = prev[i - channels] if i >= channels else 0
+            if filter_type == 1:
+                line[i] = (line[i] + a) & 0xFF
+            elif filter_type == 2:
+                line[i] = (line[i] + b) & 0xFF
+            elif filter_type == 3:
+                line[i] = (line[i] + ((a + b) >> 1)) & 0xFF
+            elif filter_type == 4:
+                p = a + b - c
+                pa, pb, pc = abs(p - a), abs(p - b), abs(p - c)
+                pred = a if pa <= pb and pa <= pc else (b if pb <= pc else c)
+                line[i] = (line[i] + pred) & 0xFF
+        prev = line
+
+        pixels = []
+        for x in range(width):
+            px = line[x * channels:(x + 1) * channels]
+            if color_type == 3:
+                index = px[0]
+                rgb = palette[index]
+                a = alpha[index] if index < len(alpha) else 255
+                pixels.append(rgb + (a,))
+            elif color_type == 2:
+                pixels.append(tuple(px) + (255,))
+            else:
+                pixels.append(tuple(px))
+        rows.append(pixels)
+    return width, height, rows
+
+
+def encode_frame(rows, x0, frame_width, colors):
+    indices = []
+    for row in rows:
+        for r, g, b, a in row[x0:x0 + frame_width]:
+            if a < 128:
+                indices.append(0)
+                continue
+            rgb = (r << 16) | (g << 8) | b
+            if rgb not in colors:
+                colors.append(rgb)
+                if len(colors) > 16:
+                    sys.exit('more than 15 colours in sprite')
+            indices.append(colors.index(rgb))
+
+    runs = []
+    i = 0
+    while i < len(indices):
+        n = 1
+        while i + n < len(indices) and indices[i + n] == indices[i] and n < 16:
+            n += 1
+        runs.append(((n - 1) << 4) | indices[i])
+        i += n
+    return runs
+
+
+def main():
+    if len(sys.argv) != 4:
+        sys.exit(__doc__)
+    path, name, frame_width = sys.argv[1], sys.argv[2], int(sys.argv[3])
+    width, height, rows = read_png(path)
+    if width % frame_width:
+        sys.exit('sheet width %d is not a multiple of %d' % (width, frame_width))
+    if frame_width > 255 or height > 255:
+        sys.exit('frames are limited to 255x255')
+
+    colors = [None]  # index 0 is transparent, opaque black gets an index of its own
+    offsets = []
+    data = []
+    for x0 in range(0, width, frame_width):
+        offsets.append(len(data))
+        data.extend(encode_frame(rows, x0, frame_width, colors))
+
+    out = ['// Generated by tools/png2sprite.py from %s' % path.split('/')[-1]]
+    out.append('const uint32_t %sPalette[] PROGMEM = {' % name)
+    out.append('  ' + ', '.join('0x%06X' % (c or 0) for c in colors))
+    out.append('};')
+    out.append('const uint16_t %sFrames[] PROGMEM = {' % name)
+    out.append('  ' + ', '.join(str(o) for o in offsets))
+    out.append('};')
+    out.append('const byte %sData[] PROGMEM = {' % name)
+    for i in range(0, len(data), 12):
+        out.append('  ' + ', '.join('0x%02X' % b for b in data[i:i + 12]) + ',')
+    out.append('};')
+    out.append('const SpriteDef %s PROGMEM = {%d, %d, %d, %sPalette, %sFrames, %sData};'
+               % (name, frame_width, height, len(offsets), name, name, name))
+    print('\n'.join(out))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,87 @@
+#!/usr/bin/env python3
+"""Report static RAM use per module and per effect from a compiled sketch.
+
+Reads the symbol table of the ELF file with nm and adds up everything in
+.data and .bss. Globals are credited to the header that defines them and
+function statics to the function they live in, so each effect's own state
+shows up on its own line.
+
+Usage: ramreport.py [--nm avr-nm] [--symbols] FindMyWay.ino.elf
+
+Get the ELF from "Sketch > Export Compiled Binary" in the Arduino IDE or from
+arduino-cli compile --output-dir. Only needs the standard library.
+"""
+
+import argparse
+import glob
+import os
+import re
+import subprocess
+import sys
+
+SOURCE_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..')
+
+# a definition at the start of a line: type, optional pointer, then the name
+DEFINITION = re.compile(r'^(?!\s|//|#|return\b|typedef\b)[\w:<>,\s\*]*?[\s\*](\w+)\s*(\[|=|;|,)')
+
+
+def source_modules():
+    """Map each global name to the file that defines it."""
+    modules = {}
+    paths = glob.glob(os.path.join(SOURCE_DIR, '*.h')) + glob.glob(os.path.join(SOURCE_DIR, '*.ino'))
+    for path in sorted(paths):
+        name = os.path.basename(path)
+        with open(path) as f:
+            for line in f:
+                match = DEFINITION.match(line)
+                if match:
+                    modules.setdefault(match.group(1), name)
+    return modules
+
+
+def ram_symbols(elf, nm):
+    try:
+        output = subprocess.check_output([nm, '-S', '-C', '--size-sort', elf], universal_newlines=True)
+    except (OSError, subprocess.CalledProcessError) as error:
+        sys.exit('could not run %s: %s' % (nm, error))
+
+    for line in output.splitlines():
+        parts = line.split(None, 3)
+        if len(parts) == 4 and parts[2] in 'bBdD':
+            yield parts[3], int(parts[1], 16)
+
+
+def owner(symbol, modules):
+    # function statics demangle as "function(args)::name"
+    symbol = symbol.replace('guard variable for ', '')
+    if '::' in symbol and '(' in symbol:
+        return 'static in ' + symbol.split('(')[0].split('::')[-1] + '()'
+    return modules.get(symbol.split('[')[0], 'libraries and core')
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Static RAM use per module and effect')
+    parser.add_argument('elf')
+    parser.add_argument('--nm', default='avr-nm', help='nm for the target (default avr-nm)')
+    parser.add_argument('--symbols', action='store_true', help='list every symbol under its module')
+    args = parser.parse_args()
+
+    modules = source_modules()
+    totals = {}
+    members = {}
+    for symbol, size in ram_symbols(args.elf, args.nm):
+        module = owner(symbol, modules)
+        totals[module] = totals.get(module, 0) + size
+        members.setdefault(module, []).append((size, symbol))
+
+    total = sum(totals.values())
+    for module, size in sorted(totals.items(), key=lambda item: -item[1]):
+        print('%6d  %s' % (size, module))
+        if args.symbols:
+            for symbol_size, symbol in sorted(members[module], reverse=True):
+                print('        %6d  %s' % (symbol_size, symbol))
+    print('%6d  total .data + .bss' % total)
+
+
+if __name__ == '__main__':
+    main()
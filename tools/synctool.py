@@ -0,0 +1,167 @@
+#!/usr/bin/env python3
+"""Watch or drive the sync link from sync.h on a Linux host.
+
+  synctool.py monitor PORT          decode the packets a leader sends
+  synctool.py lead PORT... [opts]   act as a leader for real followers
+  synctool.py lead --pty N [opts]   act as a leader on N new pseudo-terminals
+
+With --pty the tool prints the path of each pseudo-terminal it opens, and
+the followers or monitors attached to them all receive the same packets,
+so several host instances can be tried against each other without hardware.
+
+Only needs the standard library.
+"""
+
+import argparse
+import os
+import pty
+import random
+import select
+import struct
+import sys
+import termios
+import time
+import tty
+
+SYNC_START = 0xA5
+SYNC_PACKET_SIZE = 12
+SYNC_RESTART = 0x80
+BAUDS = {9600: termios.B9600, 19200: termios.B19200, 38400: termios.B38400,
+         57600: termios.B57600, 115200: termios.B115200}
+
+
+def open_port(path, baud):
+    fd = os.open(path, os.O_RDWR | os.O_NOCTTY)
+    tty.setraw(fd)
+    attrs = termios.tcgetattr(fd)
+    attrs[4] = attrs[5] = BAUDS[baud]
+    termios.tcsetattr(fd, termios.TCSANOW, attrs)
+    return fd
+
+
+def encode(millis, frame, run_mode, restart, effect, hue, seed):
+    body = struct.pack('<IBBBBH', millis & 0xFFFFFFFF, frame & 0xFF,
+                       run_mode | (SYNC_RESTART if restart else 0), effect, hue & 0xFF, seed & 0xFFFF)
+    return bytes([SYNC_START]) + body + bytes([sum(body) & 0xFF])
+
+
+def decode(packets):
+    """Yield (fields, error) for every packet found in a byte stream."""
+    buffer = bytearray()
+    for data in packets:
+        buffer += data
+        while buffer:
+            if buffer[0] != SYNC_START:
+                del buffer[0]
+                continue
+            if len(buffer) < SYNC_PACKET_SIZE:
+                break
+            packet = bytes(buffer[:SYNC_PACKET_SIZE])
+            del buffer[:SYNC_PACKET_SIZE]
+            body = packet[1:-1]
+            if sum(body) & 0xFF != packet[-1]:
+                yield None, 'bad checksum'
+                continue
+            yield struct.unpack('<IBBBBH', body), None
+
+
+def read_stream(fd):
+    while True:
+        select.select([fd], [], [])
+        yield os.read(fd, 256)
+
+
+def monitor(args):
+    fd = open_port(args.port, args.baud)
+    last_frame = None
+    lost = 0
+    for fields, error in decode(read_stream(fd)):
+        if error:
+            print(error)
+            continue
+        millis, frame, mode, effect, hue, seed = fields
+        if last_frame is not None:
+            lost += (frame - last_frame - 1) & 0xFF
+        last_frame = frame
+        print('%10d ms  frame %3d  mode %d%s  effect %2d  hue %3d  seed %04x  lost %d' % (
+            millis, frame, mode & ~SYNC_RESTART, ' restart' if mode & SYNC_RESTART else '',
+            effect, hue, seed, lost))
+
+
+def lead(args):
+    fds = []
+    if args.pty:
+        for _ in range(args.pty):
+            master, slave = pty.openpty()
+            tty.setraw(master)
+            os.set_blocking(master, False)
+            fds.append(master)
+            print(os.ttyname(slave))
+        sys.stdout.flush()
+    for path in args.ports:
+        fd = open_port(path, args.baud)
+        os.set_blocking(fd, False)
+        fds.append(fd)
+    if not fds:
+        sys.exit('give at least one port or --pty')
+
+    start = time.monotonic()
+    frame = 0
+    effect = args.effect
+    restart = True
+    effect_start = start
+    seed = random.getrandbits(16)
+    dropped = 0
+    while True:
+        now = time.monotonic()
+        if args.cycle and now - effect_start > args.cycle:
+            effect = (effect + 1) % args.effects
+            effect_start = now
+            restart = True
+
+        millis = int((now - start) * 1000)
+        hue = millis // 30  # hueTime
+        packet = encode(millis, frame, args.mode, restart, effect, hue, seed)
+        for fd in fds:
+            try:
+                os.write(fd, packet)
+            except BlockingIOError:
+                # nobody reads this one, or not fast enough: drop the packet
+                dropped += 1
+                if dropped == 1:
+                    print('dropping packets for a port nobody reads', file=sys.stderr)
+
+        frame += 1
+        restart = False
+        seed = (seed * 2053 + 13849) & 0xFFFF
+        time.sleep((args.delay + 1) / 1000.0)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Watch or drive the sync link')
+    parser.add_argument('--baud', type=int, default=38400, choices=sorted(BAUDS))
+    commands = parser.add_subparsers(dest='command')
+
+    watch = commands.add_parser('monitor', help='decode packets from a port')
+    watch.add_argument('port')
+
+    send = commands.add_parser('lead', help='send packets like a leader')
+    send.add_argument('ports', nargs='*')
+    send.add_argument('--pty', type=int, default=0, help='open this many pseudo-terminals')
+    send.add_argument('--mode', type=int, default=0, help='runMode of the followers')
+    send.add_argument('--effect', type=int, default=0, help='effect to start with')
+    send.add_argument('--effects', type=int, default=1, help='number of effects to cycle through')
+    send.add_argument('--cycle', type=float, default=0, help='seconds per effect, 0 stays on one')
+    send.add_argument('--delay', type=int, default=20, help='milliseconds between frames')
+
+    args = parser.parse_args()
+    if args.command == 'monitor':
+        monitor(args)
+    elif args.command == 'lead':
+        lead(args)
+    else:
+        parser.print_help()
+
+
+if __name__ == '__main__':
+    main()
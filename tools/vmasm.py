@@ -0,0 +1,217 @@
+#!/usr/bin/env python3
+"""Assembler for the userProgram bytecode in vm.h.
+
+  vmasm.py PROGRAM.vm                  check it and print the image
+  vmasm.py PROGRAM.vm --c              print it as a C array
+  vmasm.py PROGRAM.vm --send PORT      upload it to the board over serial
+  vmasm.py PROGRAM.vm --size 32x32     cost for another canvas size
+
+A program is a delay line and three sections, one instruction per line:
+
+  ; slantBars
+  delay 5
+  frame:          ; once per frame
+    push 0
+    ...
+  row:            ; once per row, y is set
+    ...
+  pixel:          ; once per pixel, x and y are set
+    ...
+
+Registers are r0-r7 and keep their values between sections and frames.
+Jumps go forward to a label in the same section:  jz skip ... skip:
+The image is checked with the same rules the board uses, and the number of
+instructions run per frame (on the longest path) is printed as a cost guide.
+
+Only needs the standard library.
+"""
+
+import argparse
+import os
+import sys
+import termios
+import time
+import tty
+
+# name, values popped, values pushed, immediate bytes; order gives the opcode
+OPS = [
+    ('push', 0, 1, 1), ('x', 0, 1, 0), ('y', 0, 1, 0), ('t', 0, 1, 0), ('hue', 0, 1, 0),
+    ('load', 0, 1, 1), ('store', 1, 0, 1), ('dup', 1, 2, 0), ('drop', 1, 0, 0), ('swap', 2, 2, 0),
+    ('add', 2, 1, 0), ('sub', 2, 1, 0), ('mul', 2, 1, 0), ('scale', 2, 1, 0), ('qadd', 2, 1, 0),
+    ('qsub', 2, 1, 0), ('and', 2, 1, 0), ('or', 2, 1, 0), ('xor', 2, 1, 0), ('shr', 1, 1, 1),
+    ('shl', 1, 1, 1), ('lt', 2, 1, 0), ('sin', 1, 1, 0), ('cos', 1, 1, 0), ('quad', 1, 1, 0),
+    ('tri', 1, 1, 0), ('rand', 0, 1, 0), ('jz', 1, 0, 1), ('jmp', 0, 0, 1), ('pal', 2, 0, 0),
+    ('hsv', 3, 0, 0), ('rgb', 3, 0, 0), ('set', 0, 0, 0), ('blend', 1, 0, 0), ('addc', 0, 0, 0),
+    ('fade', 1, 0, 0), ('palette', 0, 0, 1),
+]
+OPCODES = {name: (code, pops, pushes, size) for code, (name, pops, pushes, size) in enumerate(OPS)}
+SECTIONS = ('frame', 'row', 'pixel')
+
+VM_LOAD_START = 0xB5
+VM_PROGRAM_SIZE = 96
+VM_HEADER_SIZE = 4
+VM_STACK = 8
+VM_REGISTERS = 8
+
+
+class AsmError(Exception):
+    pass
+
+
+def number(text, line):
+    try:
+        value = int(text, 0)
+    except ValueError:
+        raise AsmError('line %d: expected a number, got %r' % (line, text))
+    if not 0 <= value <= 255:
+        raise AsmError('line %d: %d does not fit in a byte' % (line, value))
+    return value
+
+
+def assemble(source):
+    """Return (delay, [frame, row, pixel] code as bytearrays)."""
+    delay = 0
+    code = {name: bytearray() for name in SECTIONS}
+    labels = {name: {} for name in SECTIONS}
+    fixups = []  # (section, offset of the immediate, label, line)
+    section = None
+
+    for line, text in enumerate(source.splitlines(), 1):
+        words = text.split(';')[0].replace(',', ' ').split()
+        if not words:
+            continue
+        if words[0].endswith(':') and len(words) == 1:
+            name = words[0][:-1]
+            if name in SECTIONS:
+                section = name
+            elif section is None:
+                raise AsmError('line %d: label outside a section' % line)
+            elif name in labels[section]:
+                raise AsmError('line %d: label %s used twice' % (line, name))
+            else:
+                labels[section][name] = len(code[section])
+            continue
+        if words[0] == 'delay':
+            delay = number(words[1], line)
+            continue
+        if section is None:
+            raise AsmError('line %d: instruction before frame:, row: or pixel:' % line)
+
+        name = words[0].lower()
+        if name not in OPCODES:
+            raise AsmError('line %d: unknown instruction %r' % (line, words[0]))
+        opcode, _, _, size = OPCODES[name]
+        if len(words) != 1 + size:
+            raise AsmError('line %d: %s takes %d operand%s' % (line, name, size, '' if size == 1 else 's'))
+        code[section].append(opcode)
+        if size:
+            operand = words[1]
+            if name in ('jz', 'jmp'):
+                fixups.append((section, len(code[section]), operand, line))
+                code[section].append(0)
+            elif name in ('load', 'store'):
+                if not (operand.startswith('r') and operand[1:].isdigit()):
+                    raise AsmError('line %d: expected a register r0-r%d' % (line, VM_REGISTERS - 1))
+                code[section].append(number(operand[1:], line))
+            else:
+                code[section].append(number(operand, line))
+
+    for section, at, label, line in fixups:
+        if label not in labels[section]:
+            raise AsmError('line %d: no label %s in the %s section' % (line, label, section))
+        skip = labels[section][label] - (at + 1)
+        if skip < 0:
+            raise AsmError('line %d: jumps can only go forward' % line)
+        code[section][at] = skip
+
+    return delay, [code[name] for name in SECTIONS]
+
+
+def check_section(code, name):
+    """Apply the board's rules, return the longest path in instructions."""
+    depth = [None] * (len(code) + 1)
+    longest = [0] * (len(code) + 1)
+    depth[0] = 0
+    pc = 0
+    while pc < len(code):
+        opcode = code[pc]
+        if depth[pc] is None:
+            raise AsmError('%s: unreachable code at byte %d' % (name, pc))
+        op, pops, pushes, size = OPS[opcode]
+        after = pc + 1 + size
+        d = depth[pc] - pops
+        if d < 0:
+            raise AsmError('%s: %s at byte %d pops an empty stack' % (name, op, pc))
+        d += pushes
+        if d > VM_STACK:
+            raise AsmError('%s: stack deeper than %d at byte %d' % (name, VM_STACK, pc))
+        if op in ('load', 'store') and code[pc + 1] >= VM_REGISTERS:
+            raise AsmError('%s: no register r%d' % (name, code[pc + 1]))
+        if op in ('shr', 'shl', 'palette') and code[pc + 1] >= 8:
+            raise AsmError('%s: %s takes 0-7' % (name, op))
+
+        targets = []
+        if op in ('jz', 'jmp'):
+            targets.append(after + code[pc + 1])
+        if op != 'jmp':
+            targets.append(after)
+        for target in targets:
+            if depth[target] is not None and depth[target] != d:
+                raise AsmError('%s: stack depth differs where paths meet at byte %d' % (name, target))
+            depth[target] = d
+            longest[target] = max(longest[target], longest[pc] + 1)
+        pc = after
+    return max(longest) if code else 0
+
+
+def image(delay, sections):
+    data = bytes([delay] + [len(code) for code in sections]) + b''.join(sections)
+    if len(data) > VM_PROGRAM_SIZE:
+        raise AsmError('program is %d bytes, the limit is %d' % (len(data), VM_PROGRAM_SIZE))
+    return data
+
+
+def upload(port, data):
+    fd = os.open(port, os.O_RDWR | os.O_NOCTTY)
+    tty.setraw(fd)
+    attrs = termios.tcgetattr(fd)
+    attrs[4] = attrs[5] = termios.B115200
+    termios.tcsetattr(fd, termios.TCSANOW, attrs)
+    time.sleep(2)  # most boards reset when the port opens
+    body = bytes([len(data)]) + data
+    os.write(fd, bytes([VM_LOAD_START]) + body + bytes([sum(body) & 0xFF]))
+    termios.tcdrain(fd)
+    os.close(fd)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Assemble a userProgram effect')
+    parser.add_argument('program')
+    parser.add_argument('--c', action='store_true', help='print a C array')
+    parser.add_argument('--send', metavar='PORT', help='upload over this serial port')
+    parser.add_argument('--size', default='16x16', help='canvas WxH for the cost estimate')
+    args = parser.parse_args()
+
+    try:
+        with open(args.program) as f:
+            delay, sections = assemble(f.read())
+        paths = [check_section(code, name) for code, name in zip(sections, SECTIONS)]
+        data = image(delay, sections)
+    except AsmError as error:
+        sys.exit('%s: %s' % (args.program, error))
+
+    width, height = (int(v) for v in args.size.lower().split('x'))
+    per_frame = paths[0] + height * paths[1] + width * height * paths[2]
+    print('%d bytes, at most %d instructions per frame on %dx%d (%d per pixel)' % (
+        len(data), per_frame, width, height, paths[2]), file=sys.stderr)
+
+    if args.c:
+        print('const byte program[] PROGMEM = {%s};' % ', '.join(str(b) for b in data))
+    else:
+        print(data.hex(' '))
+    if args.send:
+        upload(args.send, data)
+
+
+if __name__ == '__main__':
+    main()
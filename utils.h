@@ -20,6 +20,47 @@ CRGB fadeBaseColor = CRGB::Black;
 
 CRGBPalette16 currentPalette(RainbowColors_p); // global palette storage
 
+// Working memory shared by effects; only the running effect may use it,
+// and it must be set up again in that effect's startup tasks
+#define SCRATCH_SIZE NUM_LEDS
+byte effectScratch[SCRATCH_SIZE] __attribute__((aligned(2))); // word aligned for the structs kept in it
+
+// Frame clock
+// frameTicks is how many of the running effect's design frames (effectDelay + 1
+// milliseconds each) have passed since its previous frame, in 8.8 fixed point.
+// Effects advance their animation by frameStep() instead of a fixed amount per
+// call, so a late frame catches up rather than slowing the animation down.
+#define FRAME_TICKS_MAX (8 * 256) // limit the jump after a long stall
+uint16_t frameTicks = 256;
+
+static_assert(FRAME_DIVIDER >= 1 && FRAME_DIVIDER * 256 <= FRAME_TICKS_MAX, "FRAME_DIVIDER must be 1 to 8");
+
+// Called by loop() right before the effect runs
+void updateFrameClock() {
+  if (effectInit == false) {
+    frameTicks = 256; // first frame of a new effect
+  } else {
+    unsigned long ticks = ((currentMillis - effectMillis) << 8) / (effectDelay + 1UL);
+    frameTicks = (ticks > FRAME_TICKS_MAX) ? FRAME_TICKS_MAX : ticks;
+  }
+  effectMillis = currentMillis;
+}
+
+// How far to move a counter that moved perFrame on every design frame
+// Keep the counter in 8.8 and pass perFrame * 256 to carry the fractions
+uint16_t frameStep(uint16_t perFrame) {
+  return ((uint32_t)perFrame * frameTicks) >> 8;
+}
+
+// Whole design frames due, for effects that move in steps (simulations,
+// scrollers). carry keeps the fraction between calls, 0 when the effect starts
+byte frameSteps(uint16_t &carry) {
+  carry += frameTicks;
+  byte steps = carry >> 8;
+  carry &= 0xFF;
+  return steps;
+}
+
 typedef void (*functionList)(); // definition for list of effect function pointers
 extern byte numEffects;
 
@@ -41,17 +82,35 @@ void fillAll(CRGB fillColor) {
 // Fade every LED in the array by a specified amount
 void fadeAll(byte fadeIncr) {
   for (int i = 0; i < NUM_LEDS; i++) {
+#ifdef DEEP_COLOR
+    deepScale(i, 255 - fadeIncr); // keeps what 8 bits round away (see deepcolor.h)
+#else
     leds[i] = leds[i].fadeToBlackBy(fadeIncr);
+#endif
   }
 }
 
 void fadeTo(CRGB basecolor, byte fadeIncr) {
   for (int i = 0; i < NUM_LEDS; i++) {
+#ifdef DEEP_COLOR
+    deepScale(i, 255 - fadeIncr);
+    deepFloor(i, basecolor);
+#else
     leds[i] = leds[i].fadeToBlackBy(fadeIncr);
     leds[i] |= basecolor;
+#endif
   }
 }
 
+// Blur the whole canvas like blur2d(), keeping the fraction with DEEP_COLOR
+void blurAll(fract8 blurAmount) {
+#ifdef DEEP_COLOR
+  deepBlur2d(blurAmount);
+#else
+  blur2d(leds, kMatrixWidth, kMatrixHeight, blurAmount);
+#endif
+}
+
 
 
 // Shift all pixels by one, right or left (0 or 1)
@@ -73,10 +132,10 @@ void scrollArray(byte scrollDir) {
 }
 
 
-// Pick a random palette from a list
-void selectRandomPalette() {
+// Pick palette n (0-7) from a list, 3 keeps the current palette
+void selectPalette(byte n) {
 
-  switch (random8(8)) {
+  switch (n) {
     case 0:
       currentPalette = CloudColors_p;
       break;
@@ -108,6 +167,11 @@ void selectRandomPalette() {
 
 }
 
+// Pick a random palette from the list
+void selectRandomPalette() {
+  selectPalette(random8(8));
+}
+
 #define NORMAL 0
 #define RAINBOW 1
 #define PALETTEWORDS 2
@@ -159,21 +223,24 @@ void confirmBlink() {
 
   if (autoCycle) { // one blue blink, auto mode active
     fillAll(CRGB::DarkBlue);
-    FastLED.show();
-    FastLED.delay(200);
+    showFrame();
+    delay(200);
     fillAll(CRGB::Black);
-    FastLED.delay(200);
+    showFrame();
+    delay(200);
   } else { // two red blinks, manual mode active
     fillAll(CRGB::DarkRed);
-    FastLED.show();
-    FastLED.delay(200);
+    showFrame();
+    delay(200);
     fillAll(CRGB::Black);
-    FastLED.delay(200);
+    showFrame();
+    delay(200);
     fillAll(CRGB::DarkRed);
-    FastLED.show();
-    FastLED.delay(200);
+    showFrame();
+    delay(200);
     fillAll(CRGB::Black);
-    FastLED.delay(200);
+    showFrame();
+    delay(200);
   }
 
 }
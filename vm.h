@@ -0,0 +1,355 @@
+// Bytecode effects loaded at runtime
+// With USER_PROGRAMS defined the userProgram effect runs a small stack machine
+// program instead of compiled code, so new effects can be tried without
+// reflashing. Programs are written in the assembly language of tools/vmasm.py,
+// which also uploads them over serial. The last upload is kept in EEPROM and
+// comes back at power up; until there is one a built-in slantBars runs.
+// An upload is received into vmStaged and runs from there at once, while
+// vmSaveStep() copies it to EEPROM VM_SAVE_BYTES per pass, so the loop never
+// waits for the whole image to be written. Uploads that start before the last
+// one is saved are ignored.
+//
+// A program has three sections. The frame section runs once per frame, the
+// row section once per row and the pixel section once per pixel, so work that
+// does not change across a row or frame is done once and kept in registers.
+// All values are bytes and arithmetic wraps like FastLED's 8-bit math.
+//
+// Image layout:
+//   0  effectDelay
+//   1  frame section length
+//   2  row section length
+//   3  pixel section length
+//   4- the three sections, one after the other
+//
+// Every image is checked before it is used: known opcodes, immediates in range,
+// jumps forward only and inside their section, and the stack depth must stay
+// between 0 and VM_STACK on every path. The interpreter can then run without
+// any checks of its own, and every program ends.
+//
+// Upload packet on Serial: VM_LOAD_START, image length, image, sum of the
+// length and image bytes, the same layout as in EEPROM. Serial can't be shared with SYNC_LEADER/FOLLOWER.
+// With SERIAL_CONTROL defined control.h reads Serial and passes uploads on.
+
+#ifdef USER_PROGRAMS
+
+#define VM_BAUD 115200
+#define VM_LOAD_START 0xB5
+#define VM_PROGRAM_SIZE 96 // largest image, header included
+#define VM_HEADER_SIZE 4
+#define VM_STACK 8
+#define VM_REGISTERS 8
+#define VM_EEPROM_ADDR 16  // after the settings: length, image, sum
+#define VM_SAVE_BYTES 1    // EEPROM bytes written per pass, each takes 3.3 ms on AVR
+
+// the running program is kept in effectScratch
+#define vmProgram effectScratch
+
+static_assert(SCRATCH_SIZE >= VM_PROGRAM_SIZE, "effectScratch is too small for user programs");
+#ifdef E2END
+static_assert(VM_EEPROM_ADDR + VM_PROGRAM_SIZE + 2 <= E2END + 1, "user programs do not fit in EEPROM");
+#endif
+
+enum {
+  VM_PUSH,    // n      push n
+  VM_X,       //        push the pixel's x
+  VM_Y,       //        push the row's y
+  VM_T,       //        push the time, one per design frame
+  VM_HUE,     //        push cycleHue
+  VM_LOAD,    // r      push register r
+  VM_STORE,   // r      pop into register r
+  VM_DUP,
+  VM_DROP,
+  VM_SWAP,
+  VM_ADD,     // a b    a + b
+  VM_SUB,     // a b    a - b
+  VM_MUL,     // a b    a * b, low byte
+  VM_SCALE,   // a b    scale8(a, b)
+  VM_QADD,    // a b    qadd8(a, b)
+  VM_QSUB,    // a b    qsub8(a, b)
+  VM_AND,
+  VM_OR,
+  VM_XOR,
+  VM_SHR,     // n  a   a >> n
+  VM_SHL,     // n  a   a << n
+  VM_LT,      // a b    255 if a < b, else 0
+  VM_SIN,     // a      sin8(a)
+  VM_COS,     // a      cos8(a)
+  VM_QUAD,    // a      quadwave8(a)
+  VM_TRI,     // a      triwave8(a)
+  VM_RAND,    //        push random8()
+  VM_JZ,      // n  a   skip the next n bytes if a is 0
+  VM_JMP,     // n      skip the next n bytes
+  VM_PAL,     // i b    color from the palette at index i, brightness b
+  VM_HSV,     // h s v  color from hue, saturation and value
+  VM_RGB,     // r g b  color from red, green and blue
+  VM_SET,     //        pixel = color
+  VM_BLEND,   // a      blend color into the pixel by a
+  VM_ADDC,    //        add color to the pixel
+  VM_FADE,    // a      fade the pixel toward black by a
+  VM_PALETTE, // n      selectPalette(n)
+  VM_OPS
+};
+
+// Per opcode: values popped << 4 | values pushed << 2 | immediate bytes
+#define VM_INFO(pops, pushes, immediate) ((pops) << 4 | (pushes) << 2 | (immediate))
+const byte vmOpInfo[VM_OPS] PROGMEM = {
+  VM_INFO(0, 1, 1), VM_INFO(0, 1, 0), VM_INFO(0, 1, 0), VM_INFO(0, 1, 0), VM_INFO(0, 1, 0), // PUSH X Y T HUE
+  VM_INFO(0, 1, 1), VM_INFO(1, 0, 1), VM_INFO(1, 2, 0), VM_INFO(1, 0, 0), VM_INFO(2, 2, 0), // LOAD STORE DUP DROP SWAP
+  VM_INFO(2, 1, 0), VM_INFO(2, 1, 0), VM_INFO(2, 1, 0), VM_INFO(2, 1, 0), VM_INFO(2, 1, 0), // ADD SUB MUL SCALE QADD
+  VM_INFO(2, 1, 0), VM_INFO(2, 1, 0), VM_INFO(2, 1, 0), VM_INFO(2, 1, 0), VM_INFO(1, 1, 1), // QSUB AND OR XOR SHR
+  VM_INFO(1, 1, 1), VM_INFO(2, 1, 0), VM_INFO(1, 1, 0), VM_INFO(1, 1, 0), VM_INFO(1, 1, 0), // SHL LT SIN COS QUAD
+  VM_INFO(1, 1, 0), VM_INFO(0, 1, 0), VM_INFO(1, 0, 1), VM_INFO(0, 0, 1), VM_INFO(2, 0, 0), // TRI RAND JZ JMP PAL
+  VM_INFO(3, 0, 0), VM_INFO(3, 0, 0), VM_INFO(0, 0, 0), VM_INFO(1, 0, 0), VM_INFO(0, 0, 0), // HSV RGB SET BLEND ADDC
+  VM_INFO(1, 0, 0), VM_INFO(0, 0, 1),                                                       // FADE PALETTE
+};
+
+// slantBars, built in for when EEPROM holds no program (tools/programs/slantbars.vm)
+const byte vmDefaultProgram[] PROGMEM = {
+  5, 9, 8, 12,
+  VM_PUSH, 0, VM_T, VM_PUSH, 4, VM_MUL, VM_SUB, VM_STORE, 0,             // r0 = -4t
+  VM_Y, VM_SHL, 4, VM_LOAD, 0, VM_ADD, VM_STORE, 1,                      // r1 = y * 16 + r0
+  VM_HUE, VM_PUSH, 255, VM_X, VM_SHL, 4, VM_LOAD, 1, VM_ADD, VM_QUAD,    // hue, 255, quadwave8(x * 16 + r1)
+  VM_HSV, VM_SET,
+};
+
+byte vmRegisters[VM_REGISTERS];
+uint16_t vmTime = 0; // 8.8, one per design frame
+
+byte vmStaged[VM_PROGRAM_SIZE + 1]; // length, image, sum of the last upload
+byte vmReceived = 0;  // upload bytes received so far, including the length
+byte vmSum = 0;
+byte vmSaveLeft = 0;  // bytes of vmStaged still to be written to EEPROM
+
+extern functionList effectListOne[];
+void userProgram();
+
+// Check one section, see the rules at the top
+boolean vmValidSection(const byte *code, byte length) {
+  int8_t depth[VM_PROGRAM_SIZE + 1]; // stack depth on reaching each byte, -1 until known
+  memset(depth, -1, length + 1);
+  depth[0] = 0;
+
+  for (byte pc = 0; pc < length; ) {
+    byte op = code[pc];
+    if (op >= VM_OPS || depth[pc] < 0) return false; // bad opcode, or code no path reaches
+    byte info = pgm_read_byte(&vmOpInfo[op]);
+    byte next = pc + 1 + (info & 3);
+    if (next > length) return false;
+
+    int8_t d = depth[pc] - (info >> 4);
+    if (d < 0) return false;
+    d += (info >> 2) & 3;
+    if (d > VM_STACK) return false;
+
+    byte immediate = (info & 3) ? code[pc + 1] : 0;
+    if ((op == VM_LOAD || op == VM_STORE) && immediate >= VM_REGISTERS) return false;
+    if ((op == VM_SHR || op == VM_SHL || op == VM_PALETTE) && immediate >= 8) return false;
+
+    if (op == VM_JZ || op == VM_JMP) {
+      uint16_t target = next + immediate;
+      if (target > length) return false;
+      if (depth[target] >= 0 && depth[target] != d) return false;
+      depth[target] = d;
+    }
+    if (op != VM_JMP) {
+      if (depth[next] >= 0 && depth[next] != d) return false;
+      depth[next] = d;
+    }
+    pc = next;
+  }
+  return true;
+}
+
+boolean vmValid(const byte *image, byte length) {
+  if (length < VM_HEADER_SIZE || length > VM_PROGRAM_SIZE) return false;
+  byte frameLength = image[1];
+  byte rowLength = image[2];
+  byte pixelLength = image[3];
+  if (VM_HEADER_SIZE + frameLength + rowLength + pixelLength != length) return false;
+
+  const byte *code = image + VM_HEADER_SIZE;
+  return vmValidSection(code, frameLength) &&
+         vmValidSection(code + frameLength, rowLength) &&
+         vmValidSection(code + frameLength + rowLength, pixelLength);
+}
+
+// Put the program saved in EEPROM, or the built-in one, into vmProgram
+void vmLoad() {
+  if (vmSaveLeft > 0) {
+    memcpy(vmProgram, vmStaged + 1, vmStaged[0]); // checked already, EEPROM is not up to date yet
+    return;
+  }
+
+  byte length = EEPROM.read(VM_EEPROM_ADDR);
+  if (length <= VM_PROGRAM_SIZE) {
+    byte sum = length;
+    for (byte i = 0; i < length; i++) {
+      vmProgram[i] = EEPROM.read(VM_EEPROM_ADDR + 1 + i);
+      sum += vmProgram[i];
+    }
+    if (sum == EEPROM.read(VM_EEPROM_ADDR + 1 + length) && vmValid(vmProgram, length)) return;
+  }
+  memcpy_P(vmProgram, vmDefaultProgram, sizeof(vmDefaultProgram));
+}
+
+// Write the next few bytes of vmStaged to EEPROM, called once per loop
+void vmSaveStep() {
+  for (byte n = 0; n < VM_SAVE_BYTES && vmSaveLeft > 0; n++) {
+    byte i = vmStaged[0] + 2 - vmSaveLeft--;
+    updateEEPROM(VM_EEPROM_ADDR + i, vmStaged[i]);
+  }
+}
+
+// Run one section, with x and y for the X and Y opcodes and pixel as the target
+void vmRun(const byte *pc, const byte *end, byte x, byte y, CRGB &pixel) {
+  byte stack[VM_STACK];
+  byte *sp = stack; // the top value is kept in top, the rest below sp
+  byte top = 0;
+  CRGB color = CRGB::Black;
+  byte a, b;
+
+  while (pc < end) {
+    switch (*pc++) {
+      case VM_PUSH:  *sp++ = top; top = *pc++; break;
+      case VM_X:     *sp++ = top; top = x; break;
+      case VM_Y:     *sp++ = top; top = y; break;
+      case VM_T:     *sp++ = top; top = vmTime >> 8; break;
+      case VM_HUE:   *sp++ = top; top = cycleHue; break;
+      case VM_LOAD:  *sp++ = top; top = vmRegisters[*pc++]; break;
+      case VM_STORE: vmRegisters[*pc++] = top; top = *--sp; break;
+      case VM_DUP:   *sp++ = top; break;
+      case VM_DROP:  top = *--sp; break;
+      case VM_SWAP:  a = sp[-1]; sp[-1] = top; top = a; break;
+      case VM_ADD:   top = *--sp + top; break;
+      case VM_SUB:   top = *--sp - top; break;
+      case VM_MUL:   top = *--sp * top; break;
+      case VM_SCALE: top = scale8(*--sp, top); break;
+      case VM_QADD:  top = qadd8(*--sp, top); break;
+      case VM_QSUB:  top = qsub8(*--sp, top); break;
+      case VM_AND:   top &= *--sp; break;
+      case VM_OR:    top |= *--sp; break;
+      case VM_XOR:   top ^= *--sp; break;
+      case VM_SHR:   top >>= *pc++; break;
+      case VM_SHL:   top <<= *pc++; break;
+      case VM_LT:    top = (*--sp < top) ? 255 : 0; break;
+      case VM_SIN:   top = sin8(top); break;
+      case VM_COS:   top = cos8(top); break;
+      case VM_QUAD:  top = quadwave8(top); break;
+      case VM_TRI:   top = triwave8(top); break;
+      case VM_RAND:  *sp++ = top; top = random8(); break;
+
+      case VM_JZ:
+        a = *pc++;
+        b = top;
+        top = *--sp;
+        if (b == 0) pc += a;
+        break;
+
+      case VM_JMP:
+        pc += *pc + 1;
+        break;
+
+      case VM_PAL:
+        a = *--sp;
+        color = ColorFromPalette(currentPalette, a, top);
+        top = *--sp;
+        break;
+
+      case VM_HSV:
+        sp -= 2;
+        color = CHSV(sp[0], sp[1], top);
+        top = *--sp;
+        break;
+
+      case VM_RGB:
+        sp -= 2;
+        color = CRGB(sp[0], sp[1], top);
+        top = *--sp;
+        break;
+
+      case VM_SET:   pixel = color; break;
+      case VM_BLEND: nblend(pixel, color, top); top = *--sp; break;
+      case VM_ADDC:  pixel += color; break;
+      case VM_FADE:  pixel.fadeToBlackBy(top); top = *--sp; break;
+      case VM_PALETTE: selectPalette(*pc++); break;
+    }
+  }
+}
+
+// Draw one frame with the program in vmProgram
+void vmFrame() {
+  const byte *frameCode = vmProgram + VM_HEADER_SIZE;
+  const byte *rowCode = frameCode + vmProgram[1];
+  const byte *pixelCode = rowCode + vmProgram[2];
+  const byte *end = pixelCode + vmProgram[3];
+
+  // the frame and row sections have no pixel of their own, they get the hidden one
+  vmRun(frameCode, rowCode, 0, 0, leds[NUM_LEDS]);
+  for (byte y = 0; y < kMatrixHeight; y++) {
+    vmRun(rowCode, pixelCode, 0, y, leds[NUM_LEDS]);
+    for (byte x = 0; x < kMatrixWidth; x++) {
+      vmRun(pixelCode, end, x, y, leds[XY(x, y)]);
+    }
+  }
+
+  vmTime += frameStep(256);
+}
+
+void userProgram() {
+
+  // startup tasks
+  if (effectInit == false) {
+    effectInit = true;
+    vmLoad();
+    memset(vmRegisters, 0, sizeof(vmRegisters));
+    vmTime = 0;
+    effectDelay = vmProgram[0];
+  }
+
+  vmFrame();
+}
+
+void vmSetup() {
+  Serial.begin(VM_BAUD);
+}
+
+// Take one byte of a program upload, the new program starts as soon as it is checked
+void vmReceiveByte(byte data) {
+  if (vmReceived == 0) {
+    if (data != VM_LOAD_START || runMode != 0 || vmSaveLeft > 0) return;
+    vmSum = 0;
+    vmReceived = 1;
+    return;
+  }
+
+  if (vmReceived == 1 && data > VM_PROGRAM_SIZE - 1) {
+    vmReceived = 0; // too long, wait for the next start
+    return;
+  }
+
+  if (vmReceived > 1 && vmReceived == vmStaged[0] + 2) {
+    // last byte, the sum
+    byte length = vmStaged[0];
+    vmReceived = 0;
+    if (data == vmSum && vmValid(vmStaged + 1, length)) {
+      vmStaged[length + 1] = data;
+      vmSaveLeft = length + 2;
+      for (byte i = 0; i < numEffects; i++) {
+        if (effectListOne[i] == userProgram) currentEffect = i;
+      }
+      effectInit = false; // userProgram loads it from vmStaged
+    }
+    return;
+  }
+
+  vmStaged[vmReceived - 1] = data;
+  vmSum += data;
+  vmReceived++;
+}
+
+// Receive program uploads on Serial
+void vmReceive() {
+  while (Serial.available() > 0) vmReceiveByte(Serial.read());
+}
+
+#endif